@@ -5,7 +5,7 @@ template <typename T, typename Alloc = std::allocator<T>>
 class Deque {
  public:
   Deque();
-  Deque(const Alloc& alloc) : alloc_(alloc){};
+  Deque(const Alloc& alloc) : alloc_(alloc), alloct_(alloc){};
   Deque(const Deque& to_copy);
   Deque(Deque&& to_copy);
   Deque(size_t count, const Alloc& alloc = Alloc());
@@ -0,0 +1,501 @@
+// Parse and print throughput of stdlike streams against std::iostream (synced
+// and unsynced), scanf/printf and from_chars/to_chars. Build from this
+// directory and run with an optional value count (default 5000000):
+//   g++ -std=c++20 -O2 -pthread benchmark.cpp iostream.cpp -o benchmark
+//   ./benchmark 5000000
+//
+// Every dataset is written once as shortest round-trip text into a temporary
+// file, which stays in the page cache for the runs that follow. Parsers read
+// that file and check their result against the generated values; printers
+// write the same values to /dev/null. MB/s always counts the dataset's text,
+// so rows that print more digits (printf and std streams use %.17g for
+// doubles) are charged for the same work. Syscall counts come from stats()
+// and exist only for stdlike rows.
+#include <fcntl.h>
+#include <unistd.h>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ext/stdio_sync_filebuf.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "iostream.hpp"
+
+namespace {
+
+struct record {
+    std::string word;
+    int number;
+    double real;
+};
+
+// Values per output line: chars run together, everything else is one per
+// line.
+template <typename T>
+constexpr size_t per_line = std::is_same_v<T, char> ? 64 : 1;
+
+uint64_t mix(uint64_t hash, uint64_t bits) {
+    return (hash ^ bits) * 0x100000001b3ULL;
+}
+
+template <typename T>
+uint64_t mix(uint64_t hash, const T& value) {
+    if constexpr (std::is_same_v<T, record>) {
+        hash = mix(hash, std::hash<std::string_view>()(value.word));
+        hash = mix(hash, static_cast<uint64_t>(value.number));
+        return mix(hash, std::bit_cast<uint64_t>(value.real));
+    } else if constexpr (std::is_same_v<T, double>) {
+        return mix(hash, std::bit_cast<uint64_t>(value));
+    } else {
+        return mix(hash, static_cast<uint64_t>(value));
+    }
+}
+
+// Datasets.
+
+template <typename T>
+std::vector<T> generate(size_t count, std::mt19937_64& random) {
+    std::vector<T> values(count);
+    if constexpr (std::is_same_v<T, char>) {
+        std::uniform_int_distribution<int> symbol('!', '~');
+        for (T& value : values) {
+            value = static_cast<char>(symbol(random));
+        }
+    } else if constexpr (std::is_same_v<T, double>) {
+        std::uniform_real_distribution<double> mantissa(-10, 10);
+        std::uniform_int_distribution<int> exponent(-12, 12);
+        for (T& value : values) {
+            value = mantissa(random) * std::pow(10.0, exponent(random));
+        }
+    } else if constexpr (std::is_same_v<T, record>) {
+        std::uniform_int_distribution<int> length(3, 10);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> number(-1000000, 1000000);
+        std::uniform_real_distribution<double> real(0, 1000);
+        for (T& value : values) {
+            value.word.resize(length(random));
+            for (char& c : value.word) {
+                c = static_cast<char>(letter(random));
+            }
+            value.number = number(random);
+            value.real = real(random);
+        }
+    } else {
+        std::uniform_int_distribution<T> any;
+        for (T& value : values) {
+            value = any(random);
+        }
+    }
+    return values;
+}
+
+// Canonical text: the shortest round-trip form, as stdlike prints it.
+template <typename T>
+char* format(char* out, const T& value) {
+    if constexpr (std::is_same_v<T, char>) {
+        *out = value;
+        return out + 1;
+    } else if constexpr (std::is_same_v<T, record>) {
+        out = std::copy(value.word.begin(), value.word.end(), out);
+        *out++ = ' ';
+        out = std::to_chars(out, out + 16, value.number).ptr;
+        *out++ = ' ';
+        return std::to_chars(out, out + 32, value.real).ptr;
+    } else {
+        return std::to_chars(out, out + 32, value).ptr;
+    }
+}
+
+// Formats values through format() into a 64 KiB buffer and hands full
+// buffers to flush(begin, size).
+template <typename T, typename Flush>
+void format_all(const std::vector<T>& values, Flush flush) {
+    constexpr size_t kChunk = 1 << 16;
+    std::vector<char> chunk(kChunk);
+    char* pos = chunk.data();
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (chunk.data() + kChunk - pos < 64) {
+            flush(chunk.data(), pos - chunk.data());
+            pos = chunk.data();
+        }
+        pos = format(pos, values[i]);
+        if ((i + 1) % per_line<T> == 0) {
+            *pos++ = '\n';
+        }
+    }
+    flush(chunk.data(), pos - chunk.data());
+}
+
+template <typename T>
+std::string write_dataset(const std::vector<T>& values) {
+    static int datasets = 0;
+    std::string path = "/tmp/stdlike_bench_" + std::to_string(getpid()) +
+                       "_" + std::to_string(datasets++);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    format_all(values, [fd](const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written <= 0) {
+                std::perror("write");
+                std::exit(1);
+            }
+            data += written;
+            size -= written;
+        }
+    });
+    close(fd);
+    return path;
+}
+
+// Readers. Each reads one value and reports whether it got one.
+
+template <typename T>
+bool read(stdlike::istream& in, T& value) {
+    if constexpr (std::is_same_v<T, record>) {
+        value.word = in.read_token();
+        in >> value.number >> value.real;
+    } else {
+        in >> value;
+    }
+    return !in.fail();
+}
+
+template <typename T>
+bool read(std::istream& in, T& value) {
+    if constexpr (std::is_same_v<T, record>) {
+        in >> value.word >> value.number >> value.real;
+    } else {
+        in >> value;
+    }
+    return static_cast<bool>(in);
+}
+
+template <typename T>
+bool read(FILE* in, T& value) {
+    if constexpr (std::is_same_v<T, int>) {
+        return std::fscanf(in, "%d", &value) == 1;
+    } else if constexpr (std::is_same_v<T, long long>) {
+        return std::fscanf(in, "%lld", &value) == 1;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return std::fscanf(in, "%lf", &value) == 1;
+    } else if constexpr (std::is_same_v<T, char>) {
+        return std::fscanf(in, " %c", &value) == 1;
+    } else {
+        char word[64];
+        if (std::fscanf(in, "%63s %d %lf", word, &value.number,
+                        &value.real) != 3) {
+            return false;
+        }
+        value.word = word;
+        return true;
+    }
+}
+
+const char* skip_space(const char* pos, const char* end) {
+    while (pos != end && (*pos == ' ' || *pos == '\n')) {
+        ++pos;
+    }
+    return pos;
+}
+
+template <typename T>
+bool parse(const char*& pos, const char* end, T& value) {
+    pos = skip_space(pos, end);
+    if constexpr (std::is_same_v<T, char>) {
+        if (pos == end) {
+            return false;
+        }
+        value = *pos++;
+        return true;
+    } else if constexpr (std::is_same_v<T, record>) {
+        const char* word_end = pos;
+        while (word_end != end && *word_end != ' ' && *word_end != '\n') {
+            ++word_end;
+        }
+        value.word.assign(pos, word_end);
+        pos = word_end;
+        return parse(pos, end, value.number) &&
+               parse(pos, end, value.real);
+    } else {
+        auto result = std::from_chars(pos, end, value);
+        pos = result.ptr;
+        return result.ec == std::errc();
+    }
+}
+
+// Writers.
+
+template <typename T>
+void write(stdlike::ostream& out, const T& value) {
+    if constexpr (std::is_same_v<T, record>) {
+        out << value.word.c_str() << ' ' << value.number << ' ' << value.real;
+    } else {
+        out << value;
+    }
+}
+
+template <typename T>
+void write(std::ostream& out, const T& value) {
+    if constexpr (std::is_same_v<T, record>) {
+        out << value.word << ' ' << value.number << ' ' << value.real;
+    } else {
+        out << value;
+    }
+}
+
+template <typename T>
+void write(FILE* out, const T& value) {
+    if constexpr (std::is_same_v<T, int>) {
+        std::fprintf(out, "%d", value);
+    } else if constexpr (std::is_same_v<T, long long>) {
+        std::fprintf(out, "%lld", value);
+    } else if constexpr (std::is_same_v<T, double>) {
+        std::fprintf(out, "%.17g", value);
+    } else if constexpr (std::is_same_v<T, char>) {
+        std::fprintf(out, "%c", value);
+    } else {
+        std::fprintf(out, "%s %d %.17g", value.word.c_str(), value.number,
+                     value.real);
+    }
+}
+
+template <typename Out, typename T>
+void write_all(Out& out, const std::vector<T>& values) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        write(out, values[i]);
+        if ((i + 1) % per_line<T> == 0) {
+            write(out, '\n');
+        }
+    }
+}
+
+// Reporting.
+
+struct dataset_info {
+    size_t values;
+    size_t bytes;
+    uint64_t checksum;
+};
+
+void print_row(const char* method, double seconds, const dataset_info& info,
+               std::optional<stdlike::io_stats> stats, bool ok = true) {
+    double megabytes = info.bytes / 1e6;
+    std::printf("  %-24s %9.1f %12.2f", method, megabytes / seconds,
+                info.values / seconds / 1e6);
+    if (stats) {
+        std::printf(" %10llu", static_cast<unsigned long long>(
+                                   stats->syscalls));
+    } else {
+        std::printf(" %10s", "-");
+    }
+    std::printf("%s\n", ok ? "" : "  MISMATCH");
+}
+
+template <typename Body>
+double time(Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Reads values until the reader gives up and folds them into a checksum.
+template <typename T, typename Read>
+uint64_t drain(size_t count, Read read_one) {
+    uint64_t checksum = 0;
+    T value{};
+    for (size_t i = 0; i < count && read_one(value); ++i) {
+        checksum = mix(checksum, value);
+    }
+    return checksum;
+}
+
+template <typename T>
+void bench_parse(const std::string& path, const dataset_info& info) {
+    std::printf("  %-24s %9s %12s %10s\n", "parse", "MB/s", "M values/s",
+                "syscalls");
+    for (bool mapped : {false, true}) {
+        uint64_t checksum;
+        int fd = open(path.c_str(), O_RDONLY);
+        stdlike::ostream unused(-1);
+        stdlike::istream in(unused, fd);
+        in.tie(nullptr);
+        double seconds = time([&] {
+            if (mapped) {
+                in.map_input();
+            }
+            checksum = drain<T>(info.values, [&](T& value) {
+                return read(in, value);
+            });
+        });
+        print_row(mapped ? "stdlike::istream mmap" : "stdlike::istream",
+                  seconds, info, in.stats(), checksum == info.checksum);
+        close(fd);
+    }
+    {
+        uint64_t checksum;
+        FILE* file = std::fopen(path.c_str(), "r");
+        double seconds = time([&] {
+            __gnu_cxx::stdio_sync_filebuf<char> buffer(file);
+            std::istream in(&buffer);
+            checksum = drain<T>(info.values, [&](T& value) {
+                return read(in, value);
+            });
+        });
+        print_row("std::istream synced", seconds, info, std::nullopt,
+                  checksum == info.checksum);
+        std::fclose(file);
+    }
+    {
+        uint64_t checksum;
+        double seconds = time([&] {
+            std::ifstream in(path);
+            checksum = drain<T>(info.values, [&](T& value) {
+                return read(static_cast<std::istream&>(in), value);
+            });
+        });
+        print_row("std::istream unsynced", seconds, info, std::nullopt,
+                  checksum == info.checksum);
+    }
+    {
+        uint64_t checksum;
+        FILE* file = std::fopen(path.c_str(), "r");
+        double seconds = time([&] {
+            checksum = drain<T>(info.values, [&](T& value) {
+                return read(file, value);
+            });
+        });
+        print_row("scanf", seconds, info, std::nullopt,
+                  checksum == info.checksum);
+        std::fclose(file);
+    }
+    {
+        uint64_t checksum;
+        double seconds = time([&] {
+            std::string text(info.bytes, '\0');
+            int fd = open(path.c_str(), O_RDONLY);
+            size_t done = 0;
+            ssize_t bytes_read;
+            while (done < text.size() &&
+                   (bytes_read = ::read(fd, text.data() + done,
+                                        text.size() - done)) > 0) {
+                done += bytes_read;
+            }
+            close(fd);
+            const char* pos = text.data();
+            const char* end = pos + done;
+            checksum = drain<T>(info.values, [&](T& value) {
+                return parse(pos, end, value);
+            });
+        });
+        print_row("from_chars (whole file)", seconds, info, std::nullopt,
+                  checksum == info.checksum);
+    }
+}
+
+template <typename T>
+void bench_print(const std::vector<T>& values, const dataset_info& info) {
+    std::printf("  %-24s %9s %12s %10s\n", "print", "MB/s", "M values/s",
+                "syscalls");
+    for (bool async : {false, true}) {
+        int fd = open("/dev/null", O_WRONLY);
+        stdlike::io_stats stats;
+        double seconds = time([&] {
+            stdlike::ostream out(fd);
+            if (async) {
+                out.enable_async();
+            }
+            write_all(out, values);
+            out.flush();
+            stats = out.stats();
+        });
+        print_row(async ? "stdlike::ostream async" : "stdlike::ostream",
+                  seconds, info, stats);
+        close(fd);
+    }
+    {
+        FILE* file = std::fopen("/dev/null", "w");
+        double seconds = time([&] {
+            __gnu_cxx::stdio_sync_filebuf<char> buffer(file);
+            std::ostream out(&buffer);
+            out.precision(17);
+            write_all(out, values);
+            out.flush();
+        });
+        print_row("std::ostream synced", seconds, info, std::nullopt);
+        std::fclose(file);
+    }
+    {
+        double seconds = time([&] {
+            std::ofstream out("/dev/null");
+            out.precision(17);
+            write_all(static_cast<std::ostream&>(out), values);
+            out.flush();
+        });
+        print_row("std::ostream unsynced", seconds, info, std::nullopt);
+    }
+    {
+        FILE* file = std::fopen("/dev/null", "w");
+        double seconds = time([&] {
+            write_all(file, values);
+            std::fflush(file);
+        });
+        print_row("printf", seconds, info, std::nullopt);
+        std::fclose(file);
+    }
+    {
+        int fd = open("/dev/null", O_WRONLY);
+        double seconds = time([&] {
+            format_all(values, [fd](const char* data, size_t size) {
+                if (::write(fd, data, size) < 0) {
+                    std::perror("write");
+                }
+            });
+        });
+        print_row("to_chars (64 KiB chunks)", seconds, info, std::nullopt);
+        close(fd);
+    }
+}
+
+template <typename T>
+void bench(const char* name, size_t count, std::mt19937_64& random) {
+    std::vector<T> values = generate<T>(count, random);
+    std::string path = write_dataset(values);
+    dataset_info info{count, 0, 0};
+    for (const T& value : values) {
+        info.checksum = mix(info.checksum, value);
+    }
+    int fd = open(path.c_str(), O_RDONLY);
+    info.bytes = lseek(fd, 0, SEEK_END);
+    close(fd);
+
+    std::printf("%s: %zu values, %.1f MB\n", name, count, info.bytes / 1e6);
+    bench_parse<T>(path, info);
+    bench_print(values, info);
+    std::printf("\n");
+    unlink(path.c_str());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+    std::mt19937_64 random(42);
+    bench<int>("int", count, random);
+    bench<long long>("long long", count, random);
+    bench<double>("double", count, random);
+    bench<char>("char", count, random);
+    bench<record>("mixed (word int double)", count, random);
+}
@@ -1,7 +1,24 @@
 #include "iostream.hpp"
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <deque>
 #include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 namespace stdlike {
 
@@ -9,33 +26,147 @@ istream cin(cout);
 ostream cout;
 
 istream::istream(ostream& output_stream)
-    : buffer_pos(0), buffer_end(0), output_stream(output_stream) {
+    : istream(output_stream, STDIN_FILENO) {
+}
+
+istream::istream(ostream& output_stream, int fd, size_t buffer_size)
+    : input_fd(fd),
+      buffer_size(buffer_size > 0 ? buffer_size : 1),
+      buffer(new char[this->buffer_size]),
+      data(buffer.get()),
+      buffer_pos(0),
+      buffer_end(0),
+      tied_stream(&output_stream) {
+    struct stat info;
+    blocking_input = fstat(fd, &info) != 0 || !S_ISREG(info.st_mode);
+}
+
+istream::~istream() {
+    if (mapping != nullptr) {
+        munmap(mapping, mapping_size);
+    }
+}
+
+int istream::fd() const {
+    return input_fd;
+}
+
+bool istream::advise_sequential() {
+    if (mapping != nullptr) {
+        return madvise(mapping, mapping_size, MADV_SEQUENTIAL) == 0;
+    }
+    return posix_fadvise(input_fd, 0, 0, POSIX_FADV_SEQUENTIAL) == 0;
+}
+
+bool istream::map_input() {
+    if (mapping != nullptr) {
+        return true;
+    }
+    struct stat info;
+    if (fstat(input_fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    off_t offset = lseek(input_fd, 0, SEEK_CUR);
+    size_t unread = buffer_end - buffer_pos;
+    if (offset < 0 || static_cast<size_t>(offset) < unread ||
+        info.st_size <= offset) {
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* region = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, input_fd, 0);
+    ++counters.syscalls;
+    if (region == MAP_FAILED) {
+        return false;
+    }
+    counters.bytes += size - static_cast<size_t>(offset);
+    mapping = region;
+    mapping_size = size;
+    // Resume from the first byte not yet handed out, which may already sit
+    // in the buffer.
+    data = static_cast<const char*>(region);
+    buffer_pos = static_cast<size_t>(offset) - unread;
+    buffer_end = size;
+    lseek(input_fd, 0, SEEK_END);
+    return true;
+}
+
+bool istream::mapped() const {
+    return mapping != nullptr;
+}
+
+io_stats istream::stats() const {
+    return counters;
+}
+
+ostream* istream::tie() const {
+    return tied_stream;
+}
+
+ostream* istream::tie(ostream* output_stream) {
+    ostream* previous = tied_stream;
+    tied_stream = output_stream;
+    return previous;
 }
 
 bool istream::fail() const {
     return fail_flag;
 }
 
-bool ostream::fail() const {
-    return fail_flag;
+bool istream::fill_buffer() {
+    if (mapping != nullptr) {
+        return false;
+    }
+    buffer_pos = 0;
+    buffer_end = 0;
+    return extend_window();
 }
 
-void istream::fill_buffer() {
-    ssize_t bytes_read = read(STDIN_FILENO, buffer, buffer_size);
+bool istream::extend_window() {
+    if (mapping != nullptr) {
+        return false;
+    }
+    if (buffer_pos > 0) {
+        memmove(buffer.get(), data + buffer_pos, buffer_end - buffer_pos);
+        buffer_end -= buffer_pos;
+        buffer_pos = 0;
+    }
+    if (buffer_end == buffer_size) {
+        std::unique_ptr<char[]> larger(new char[2 * buffer_size]);
+        memcpy(larger.get(), buffer.get(), buffer_end);
+        buffer = std::move(larger);
+        buffer_size *= 2;
+        data = buffer.get();
+    }
+    ssize_t bytes_read =
+        read_input(buffer.get() + buffer_end, buffer_size - buffer_end);
     if (bytes_read < 0) {
         fail_flag = true;
-        buffer_end = 0;
-    } else {
-        buffer_end = static_cast<size_t>(bytes_read);
+        return false;
     }
-    buffer_pos = 0;
+    buffer_end += static_cast<size_t>(bytes_read);
+    return bytes_read > 0;
+}
+
+ssize_t istream::read_input(char* out, size_t size) {
+    if (tied_stream != nullptr && blocking_input) {
+        tied_stream->flush();
+    }
+    ssize_t bytes_read;
+    do {
+        bytes_read = read(input_fd, out, size);
+        ++counters.syscalls;
+    } while (bytes_read < 0 && errno == EINTR);
+    if (bytes_read > 0) {
+        counters.bytes += static_cast<size_t>(bytes_read);
+    }
+    return bytes_read;
 }
 
 char istream::get() {
-    if (buffer_pos >= buffer_end) {
-        fill_buffer();
+    if (buffer_pos >= buffer_end && !fill_buffer()) {
+        return '\0';
     }
-    return (buffer_end > 0) ? buffer[buffer_pos++] : '\0';
+    return data[buffer_pos++];
 }
 
 void istream::unget() {
@@ -45,52 +176,131 @@ void istream::unget() {
 }
 
 char istream::peek() {
-    if (buffer_pos >= buffer_end) {
-        fill_buffer();
+    if (buffer_pos >= buffer_end && !fill_buffer()) {
+        return '\0';
+    }
+    return data[buffer_pos];
+}
+
+void istream::skip_whitespace() {
+    char curr = peek();
+    while (curr == ' ' || curr == '\n' || curr == '\t') {
+        ++buffer_pos;
+        curr = peek();
+    }
+}
+
+namespace {
+
+const uint64_t power_of_ten[] = {1,      10,      100,      1000,     10000,
+                                 100000, 1000000, 10000000, 100000000};
+
+// Number of leading bytes of chunk (first byte in the low bits) that are
+// ASCII digits. A byte adds 6 without carrying into its neighbour unless it
+// is >= 0xfa, and such a byte already ends the run.
+size_t leading_digits(uint64_t chunk) {
+    const uint64_t high_nibbles = 0xf0f0f0f0f0f0f0f0;
+    const uint64_t zeros = 0x3030303030303030;
+    const uint64_t sixes = 0x0606060606060606;
+    uint64_t not_digit = ((chunk & high_nibbles) ^ zeros) |
+                         (((chunk + sixes) & high_nibbles) ^ zeros);
+    return not_digit == 0 ? 8 : __builtin_ctzll(not_digit) / 8;
+}
+
+// Value of the first count digits of chunk, three multiplies for all eight.
+uint64_t parse_digits(uint64_t chunk, size_t count) {
+    chunk <<= 8 * (8 - count);
+    chunk = ((chunk & 0x0f0f0f0f0f0f0f0f) * 2561) >> 8;
+    chunk = ((chunk & 0x00ff00ff00ff00ff) * 6553601) >> 16;
+    return ((chunk & 0x0000ffff0000ffff) * 42949672960001) >> 32;
+}
+
+// value = value * multiplier +- part; signed values are accumulated as
+// negatives so that min() is reachable. False on overflow.
+template <typename T>
+bool accumulate(T& value, uint64_t part, uint64_t multiplier) {
+    if (__builtin_mul_overflow(value, static_cast<T>(multiplier), &value)) {
+        return false;
+    }
+    if constexpr (std::is_signed_v<T>) {
+        return !__builtin_sub_overflow(value, static_cast<T>(part), &value);
+    } else {
+        return !__builtin_add_overflow(value, static_cast<T>(part), &value);
+    }
+}
+
+}  // namespace
+
+template <typename T>
+bool istream::ScanDigits(T& value, bool& overflow) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (buffer_end - buffer_pos >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, data + buffer_pos, sizeof(chunk));
+        size_t count = leading_digits(chunk);
+        if (count == 0) {
+            return true;
+        }
+        uint64_t part = parse_digits(chunk, count);
+        if (!accumulate(value, part, power_of_ten[count])) {
+            overflow = true;
+        }
+        buffer_pos += count;
+        if (count < 8) {
+            return true;
+        }
+    }
+#endif
+    while (buffer_pos < buffer_end) {
+        char curr = data[buffer_pos];
+        if (curr < '0' || curr > '9') {
+            return true;
+        }
+        if (!accumulate(value, curr - '0', 10)) {
+            overflow = true;
+        }
+        ++buffer_pos;
     }
-    return (buffer_end > 0) ? buffer[buffer_pos] : '\0';
+    return false;
 }
 
 template <typename T>
 istream& istream::ReadNumber(T& value) {
     value = 0;
-    output_stream.flush();
+    skip_whitespace();
     char curr = peek();
     bool negative = false;
 
-    while (curr == ' ' || curr == '\n' || curr == '\t') {
-        curr = get();
+    if (curr == '-' || curr == '+') {
+        negative = curr == '-';
+        ++buffer_pos;
+        curr = peek();
     }
 
-    if (curr != '-' && curr != '+' && (curr < '0' || curr > '9')) {
+    if (curr < '0' || curr > '9') {
         fail_flag = true;
         return *this;
     }
 
-    if (curr == '-') {
-        negative = true;
-        curr = get();
-    } else if (curr == '+') {
-        curr = get();
-    }
-
-    while (curr >= '0' && curr <= '9') {
-        value = value * 10 - (curr - '0');
-        curr = get();
+    bool overflow = false;
+    while (!ScanDigits(value, overflow) && fill_buffer()) {
     }
 
-    if (!negative) {
-        if (value == std::numeric_limits<T>::min()) {
-            fail_flag = true;
-        } else {
-            value = -value;
+    if (overflow) {
+        fail_flag = true;
+        value = negative && std::is_signed_v<T> ? std::numeric_limits<T>::min()
+                                                : std::numeric_limits<T>::max();
+    } else if constexpr (std::is_signed_v<T>) {
+        if (!negative) {
+            if (value == std::numeric_limits<T>::min()) {
+                fail_flag = true;
+            } else {
+                value = -value;
+            }
         }
+    } else if (negative) {
+        value = -value;
     }
-
-    if (peek() != '\0') {
-        --buffer_pos;
-    }
-    output_stream.flush();
     return *this;
 }
 
@@ -110,57 +320,62 @@ istream& istream::operator>>(unsigned long long& value) {
     return ReadNumber<unsigned long long>(value);
 }
 
-template <typename T>
-istream& istream::ReadReal(T& value) {
-    value = 0.0;
-    bool negative = false;
-    bool decimal_point_found = false;
-    bool has_digits = false;
-    double decimal_factor = 0.1;
-    output_stream.flush();
-    char curr = get();
+namespace {
 
-    while (curr == ' ' || curr == '\n' || curr == '\t') {
-        output_stream.flush();
-        curr = get();
-    }
+// Characters that can continue a real: digits, point, exponent and its sign,
+// and the letters and parentheses of inf, infinity and nan(...).
+bool real_char(char curr) {
+    return (curr >= '0' && curr <= '9') || (curr >= 'a' && curr <= 'z') ||
+           (curr >= 'A' && curr <= 'Z') || curr == '.' || curr == '-' ||
+           curr == '+' || curr == '(' || curr == ')' || curr == '_';
+}
 
-    if (curr == '-') {
-        negative = true;
-        output_stream.flush();
-        curr = get();
-    } else if (curr == '+') {
-        output_stream.flush();
-        curr = get();
+}  // namespace
+
+size_t istream::real_length() const {
+    size_t end = buffer_pos;
+    size_t limit = buffer_pos + std::min(buffer_end - buffer_pos,
+                                         max_real_length + 1);
+    while (end < limit && real_char(data[end])) {
+        ++end;
     }
-    while ((curr >= '0' && curr <= '9') || curr == '.') {
-        if (curr >= '0' && curr <= '9') {
-            has_digits = true;
-            if (!decimal_point_found) {
-                value = value * 10 + (curr - '0');
-            } else {
-                value += (curr - '0') * decimal_factor;
-                decimal_factor /= 10;
-            }
-        } else if (curr == '.') {
-            if (decimal_point_found) {
-                break;
-            }
-            decimal_point_found = true;
+    return end - buffer_pos;
+}
+
+template <typename T>
+istream& istream::ReadReal(T& value) {
+    value = 0.0;
+    skip_whitespace();
+    // from_chars takes '-' but not '+', so an explicit plus is dropped here.
+    if (peek() == '+') {
+        ++buffer_pos;
+        if (peek() == '-') {
+            fail_flag = true;
+            return *this;
         }
-        output_stream.flush();
-        curr = get();
     }
 
-    if (!has_digits) {
-        value = 0.0;
+    // A token running into the end of the window is completed in place, so
+    // only the characters from_chars accepts are consumed whatever the
+    // buffer size or mode. A run longer than any real stops the growth and
+    // fails without consuming anything.
+    size_t length = real_length();
+    while (length <= max_real_length && buffer_pos + length == buffer_end &&
+           extend_window()) {
+        length = real_length();
+    }
+    if (length > max_real_length) {
+        fail_flag = true;
         return *this;
     }
-    unget();
-    if (negative) {
-        value = -value;
+
+    const char* begin = data + buffer_pos;
+    std::from_chars_result result =
+        std::from_chars(begin, begin + length, value);
+    buffer_pos = result.ptr - data;
+    if (result.ec != std::errc()) {
+        fail_flag = true;
     }
-    output_stream.flush();
     return *this;
 }
 
@@ -173,14 +388,11 @@ istream& istream::operator>>(float& value) {
 }
 
 istream& istream::operator>>(char& value) {
-    output_stream.flush();
     char curr = get();
     while (curr == ' ' || curr == '\n' || curr == '\t') {
-        output_stream.flush();
         curr = get();
     }
     value = curr;
-    output_stream.flush();
     return *this;
 }
 
@@ -188,48 +400,807 @@ istream& istream::operator>>(bool& value) {
     int temp = 0;
     *this >> temp;
     value = (temp != 0);
-    output_stream.flush();
     return *this;
 }
 
-ostream::ostream() : buffer_pos(0) {
+bool istream::read_bytes(char* out, size_t size) {
+    while (size > 0) {
+        if (buffer_pos >= buffer_end) {
+            // Large reads skip the buffer once it is drained.
+            if (mapping == nullptr && size >= buffer_size) {
+                ssize_t bytes_read = read_input(out, size);
+                if (bytes_read > 0) {
+                    out += bytes_read;
+                    size -= static_cast<size_t>(bytes_read);
+                    continue;
+                }
+            }
+            if (!fill_buffer()) {
+                fail_flag = true;
+                return false;
+            }
+        }
+        size_t chunk = std::min(size, buffer_end - buffer_pos);
+        memcpy(out, data + buffer_pos, chunk);
+        buffer_pos += chunk;
+        out += chunk;
+        size -= chunk;
+    }
+    return true;
 }
 
-void ostream::flush_buffer() {
-    if (buffer_pos > 0) {
-        ssize_t written = write(STDOUT_FILENO, buffer, buffer_pos);
+bool istream::read_varint_bits(uint64_t& bits) {
+    bits = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (buffer_pos >= buffer_end && !fill_buffer()) {
+            fail_flag = true;
+            return false;
+        }
+        unsigned char byte = static_cast<unsigned char>(data[buffer_pos++]);
+        bits |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            // The tenth byte may only carry the top bit.
+            if (shift == 63 && byte > 1) {
+                break;
+            }
+            return true;
+        }
+    }
+    fail_flag = true;
+    return false;
+}
+
+template <typename Find>
+std::string_view istream::ReadUntil(Find find) {
+    size_t end = find(data + buffer_pos, data + buffer_end) - data;
+    if (end < buffer_end || mapping != nullptr) {
+        std::string_view view(data + buffer_pos, end - buffer_pos);
+        buffer_pos = end;
+        return view;
+    }
+    spill.assign(data + buffer_pos, end - buffer_pos);
+    buffer_pos = end;
+    while (fill_buffer()) {
+        end = find(data, data + buffer_end) - data;
+        spill.append(data, end);
+        buffer_pos = end;
+        if (end < buffer_end) {
+            break;
+        }
+    }
+    return spill;
+}
+
+std::string_view istream::read_token() {
+    skip_whitespace();
+    std::string_view token =
+        ReadUntil([](const char* begin, const char* end) {
+            return std::find_if(begin, end, [](char curr) {
+                return curr == ' ' || curr == '\n' || curr == '\t';
+            });
+        });
+    if (token.empty()) {
+        fail_flag = true;
+    }
+    return token;
+}
+
+std::string_view istream::read_line() {
+    if (buffer_pos >= buffer_end && !fill_buffer()) {
+        fail_flag = true;
+        return {};
+    }
+    std::string_view line =
+        ReadUntil([](const char* begin, const char* end) {
+            const void* newline = memchr(begin, '\n', end - begin);
+            return newline == nullptr ? end
+                                      : static_cast<const char*>(newline);
+        });
+    if (buffer_pos < buffer_end) {
+        ++buffer_pos;
+    }
+    return line;
+}
+
+namespace {
+
+// Writes all of [str, str + size), resuming after partial writes; adds
+// the number of write calls made to calls.
+bool write_all(int fd, const char* str, size_t size, uint64_t& calls) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, str, size);
+        ++calls;
         if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        str += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+template <typename U>
+size_t count_digits(U value) {
+    size_t count = 1;
+    while (value >= 100) {
+        value /= 100;
+        count += 2;
+    }
+    return value >= 10 ? count + 1 : count;
+}
+
+}  // namespace
+
+namespace {
+
+// The slice of io_uring the async writer needs, on the raw syscalls: a
+// ring with at most one write in flight, submitted and reaped by the
+// thread that owns it.
+class io_ring {
+public:
+    io_ring() = default;
+    io_ring(const io_ring&) = delete;
+    io_ring& operator=(const io_ring&) = delete;
+
+    ~io_ring() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sq_ring != MAP_FAILED) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        if (ring_fd >= 0) {
+            close(ring_fd);
+        }
+    }
+
+    // False when the kernel has no io_uring, forbids it (ENOSYS, EPERM) or
+    // cannot write at the file position, which ordered output relies on.
+    bool setup() {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, 2, &params));
+        if (ring_fd < 0 || (params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+            return false;
+        }
+        sq_ring_size =
+            params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        }
+        sq_ring = map(sq_ring_size, IORING_OFF_SQ_RING);
+        cq_ring = single_mmap ? sq_ring : map(cq_ring_size, IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+        if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED ||
+            sqes == MAP_FAILED) {
+            return false;
+        }
+        char* sq = static_cast<char*>(sq_ring);
+        char* cq = static_cast<char*>(cq_ring);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // Queues a write at the current file position; one io_uring_enter. On
+    // false the entry is still queued, and the next enter would submit it,
+    // so the caller must drop the ring rather than reuse str.
+    bool submit_write(int fd, const char* str, size_t size) {
+        unsigned tail = *sq_tail;
+        unsigned index = tail & *sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(str);
+        sqe->len = static_cast<uint32_t>(std::min<size_t>(size, 1u << 30));
+        sqe->off = static_cast<uint64_t>(-1);
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        int submitted;
+        do {
+            submitted = enter(1, 0, 0);
+        } while (submitted < 0 && errno == EINTR);
+        return submitted == 1;
+    }
+
+    bool completion_ready() const {
+        return *cq_head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    }
+
+    // Stores the result of the next completion, entering the kernel to
+    // wait for it if none is posted yet; entered reports whether it had to.
+    // False if waiting failed for good, in which case the write may still
+    // be in progress.
+    bool wait_completion(int& result, bool& entered) {
+        entered = false;
+        while (!completion_ready()) {
+            entered = true;
+            if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR &&
+                errno != EAGAIN && errno != EBUSY) {
+                return false;
+            }
+        }
+        unsigned head = *cq_head;
+        result = cqes[head & *cq_mask].res;
+        __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void* map(size_t size, off_t offset) {
+        return mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+    }
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd,
+                                        to_submit, min_complete, flags,
+                                        nullptr, 0));
+    }
+
+    int ring_fd = -1;
+    void* sq_ring = MAP_FAILED;
+    void* cq_ring = MAP_FAILED;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sq_ring_size = 0;
+    size_t cq_ring_size = 0;
+    size_t sqes_size = 0;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+};
+
+}  // namespace
+
+// Writes full buffers without blocking the formatting thread. With io_uring
+// the submitting thread drives the ring itself and only waits when every
+// buffer is in flight; otherwise a background thread does blocking writes.
+// Either way buffers reach the fd in the order they were submitted. If the
+// ring fails, the writer drops it and carries on with the thread.
+class async_writer {
+public:
+    async_writer(int fd, size_t buffer_size, size_t buffer_count,
+                 bool use_io_uring)
+        : fd(fd), buffer_size(buffer_size) {
+        // The caller keeps filling one buffer of its own.
+        for (size_t i = 1; i < std::max<size_t>(buffer_count, 2); ++i) {
+            free_buffers.emplace_back(new char[buffer_size]);
+        }
+        if (use_io_uring) {
+            ring = std::make_unique<io_ring>();
+            if (!ring->setup()) {
+                ring.reset();
+            }
+        }
+        if (ring == nullptr) {
+            thread = std::thread([this] { run(); });
+        }
+    }
+
+    ~async_writer() {
+        if (ring != nullptr) {
+            wait_idle();
+        }
+        if (ring != nullptr) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        work_ready.notify_one();
+        thread.join();
+    }
+
+    bool uses_io_uring() const {
+        return ring != nullptr;
+    }
+
+    // Queues the first size bytes of full and returns an empty buffer.
+    std::unique_ptr<char[]> submit(std::unique_ptr<char[]> full,
+                                   size_t size) {
+        std::unique_lock<std::mutex> lock(mutex);
+        pending.emplace_back(std::move(full), size);
+        if (ring != nullptr) {
+            while (ring != nullptr && writing && ring->completion_ready()) {
+                reap();
+            }
+            start_next();
+            while (ring != nullptr && free_buffers.empty()) {
+                reap();
+            }
+        } else {
+            work_ready.notify_one();
+        }
+        buffer_ready.wait(lock, [this] { return !free_buffers.empty(); });
+        return take_free_buffer();
+    }
+
+    void wait_idle() {
+        while (ring != nullptr && writing) {
+            reap();
+        }
+        if (ring != nullptr) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        buffer_ready.wait(lock, [this] { return pending.empty() && !writing; });
+    }
+
+    bool failed() const {
+        return error.load(std::memory_order_relaxed);
+    }
+
+    io_stats stats() const {
+        return {syscalls.load(std::memory_order_relaxed),
+                bytes.load(std::memory_order_relaxed)};
+    }
+
+private:
+    std::unique_ptr<char[]> take_free_buffer() {
+        std::unique_ptr<char[]> empty = std::move(free_buffers.back());
+        free_buffers.pop_back();
+        return empty;
+    }
+
+    // Ring mode: puts the oldest pending buffer in flight if none is.
+    void start_next() {
+        if (ring == nullptr || writing || pending.empty()) {
+            return;
+        }
+        in_flight = std::move(pending.front());
+        pending.pop_front();
+        in_flight_done = 0;
+        writing = true;
+        submit_rest();
+    }
+
+    void submit_rest() {
+        syscalls.fetch_add(1, std::memory_order_relaxed);
+        if (!ring->submit_write(fd, in_flight.first.get() + in_flight_done,
+                                in_flight.second - in_flight_done)) {
+            abandon_ring(false);
+        }
+    }
+
+    // Ring mode: consumes one completion, resubmitting short writes.
+    void reap() {
+        int result;
+        bool entered;
+        bool completed = ring->wait_completion(result, entered);
+        if (entered) {
+            syscalls.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!completed) {
+            abandon_ring(true);
+            return;
+        }
+        if (result == -EINTR || result == -EAGAIN) {
+            submit_rest();
+            return;
+        }
+        if (result <= 0) {
+            error.store(true, std::memory_order_relaxed);
+            finish_in_flight();
+            return;
+        }
+        bytes.fetch_add(result, std::memory_order_relaxed);
+        in_flight_done += static_cast<size_t>(result);
+        if (in_flight_done < in_flight.second) {
+            submit_rest();
+            return;
+        }
+        finish_in_flight();
+    }
+
+    void finish_in_flight() {
+        free_buffers.push_back(std::move(in_flight.first));
+        writing = false;
+        start_next();
+    }
+
+    // Ring mode, on a failed io_uring_enter: closes the ring, which discards
+    // any entry it has not consumed, and hands the rest of the output to a
+    // writer thread. A write whose outcome is unknown may still be reading
+    // its buffer, so that buffer is left to it and replaced; otherwise the
+    // unwritten part of the buffer is written here first.
+    void abandon_ring(bool write_in_progress) {
+        ring.reset();
+        if (write_in_progress) {
+            error.store(true, std::memory_order_relaxed);
+            static_cast<void>(in_flight.first.release());
+            free_buffers.emplace_back(new char[buffer_size]);
+        } else {
+            uint64_t calls = 0;
+            size_t rest = in_flight.second - in_flight_done;
+            if (!write_all(fd, in_flight.first.get() + in_flight_done, rest,
+                           calls)) {
+                error.store(true, std::memory_order_relaxed);
+            }
+            syscalls.fetch_add(calls, std::memory_order_relaxed);
+            bytes.fetch_add(rest, std::memory_order_relaxed);
+            free_buffers.push_back(std::move(in_flight.first));
+        }
+        writing = false;
+        thread = std::thread([this] { run(); });
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            work_ready.wait(lock,
+                            [this] { return !pending.empty() || stopping; });
+            if (pending.empty()) {
+                return;
+            }
+            std::pair<std::unique_ptr<char[]>, size_t> job =
+                std::move(pending.front());
+            pending.pop_front();
+            writing = true;
+            lock.unlock();
+            uint64_t calls = 0;
+            if (!write_all(fd, job.first.get(), job.second, calls)) {
+                error.store(true, std::memory_order_relaxed);
+            }
+            syscalls.fetch_add(calls, std::memory_order_relaxed);
+            bytes.fetch_add(job.second, std::memory_order_relaxed);
+            lock.lock();
+            writing = false;
+            free_buffers.push_back(std::move(job.first));
+            buffer_ready.notify_all();
+        }
+    }
+
+    int fd;
+    size_t buffer_size;
+    std::unique_ptr<io_ring> ring;
+    std::pair<std::unique_ptr<char[]>, size_t> in_flight;
+    size_t in_flight_done = 0;
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable buffer_ready;
+    std::deque<std::pair<std::unique_ptr<char[]>, size_t>> pending;
+    std::vector<std::unique_ptr<char[]>> free_buffers;
+    bool writing = false;
+    bool stopping = false;
+    std::atomic<bool> error{false};
+    std::atomic<uint64_t> syscalls{0};
+    std::atomic<uint64_t> bytes{0};
+    std::thread thread;
+};
+
+ostream::ostream() : ostream(STDOUT_FILENO) {
+}
+
+ostream::ostream(int fd, size_t buffer_size)
+    : output_fd(fd),
+      buffer_size(buffer_size > 0 ? buffer_size : 1),
+      buffer(new char[this->buffer_size]),
+      buffer_pos(0) {
+}
+
+// Multi-producer, single-consumer queue of filled buffers (Vyukov's
+// intrusive list): producers link a chunk with one exchange on head, and
+// only the writer thread walks from tail.
+struct shared_writer::queue {
+    struct chunk {
+        std::atomic<chunk*> next{nullptr};
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+        std::atomic<uint64_t>* written = nullptr;
+    };
+
+    explicit queue(int fd) : fd(fd), head(new chunk), tail(head.load()) {
+        thread = std::thread([this] { run(); });
+    }
+
+    ~queue() {
+        stopping.store(true, std::memory_order_release);
+        pushed.fetch_add(1, std::memory_order_release);
+        pushed.notify_one();
+        thread.join();
+        delete tail;
+    }
+
+    void push(chunk* item) {
+        chunk* previous = head.exchange(item, std::memory_order_acq_rel);
+        previous->next.store(item, std::memory_order_release);
+        pushed.fetch_add(1, std::memory_order_release);
+        pushed.notify_one();
+    }
+
+    // Blocks until *written, bumped by the writer per chunk, reaches target.
+    void wait_written(const std::atomic<uint64_t>& written, uint64_t target) {
+        while (true) {
+            uint64_t seen = completed.load(std::memory_order_acquire);
+            if (written.load(std::memory_order_acquire) >= target) {
+                return;
+            }
+            completed.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    void run() {
+        while (true) {
+            uint64_t seen = pushed.load(std::memory_order_acquire);
+            chunk* next = tail->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                if (stopping.load(std::memory_order_acquire)) {
+                    return;
+                }
+                pushed.wait(seen, std::memory_order_acquire);
+                continue;
+            }
+            uint64_t calls = 0;
+            if (!write_all(fd, next->data.get(), next->size, calls)) {
+                error.store(true, std::memory_order_relaxed);
+            }
+            syscalls.fetch_add(calls, std::memory_order_relaxed);
+            bytes.fetch_add(next->size, std::memory_order_relaxed);
+            next->data.reset();
+            delete tail;
+            tail = next;
+            // The producer may be gone as soon as it sees its count, so
+            // it is woken through completed, which the writer owns.
+            next->written->fetch_add(1, std::memory_order_release);
+            completed.fetch_add(1, std::memory_order_release);
+            completed.notify_all();
+        }
+    }
+
+    int fd;
+    std::atomic<chunk*> head;
+    chunk* tail;
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> error{false};
+    std::atomic<uint64_t> syscalls{0};
+    std::atomic<uint64_t> bytes{0};
+    std::thread thread;
+};
+
+shared_writer::shared_writer(int fd) : impl(std::make_unique<queue>(fd)) {
+}
+
+shared_writer::~shared_writer() = default;
+
+int shared_writer::fd() const {
+    return impl->fd;
+}
+
+bool shared_writer::fail() const {
+    return impl->error.load(std::memory_order_relaxed);
+}
+
+io_stats shared_writer::stats() const {
+    return {impl->syscalls.load(std::memory_order_relaxed),
+            impl->bytes.load(std::memory_order_relaxed)};
+}
+
+ostream::ostream(shared_writer& sink, size_t buffer_size)
+    : ostream(sink.fd(), buffer_size) {
+    this->sink = &sink;
+}
+
+ostream::~ostream() {
+    flush();
+    async.reset();
+}
+
+int ostream::fd() const {
+    return output_fd;
+}
+
+bool ostream::fail() const {
+    return fail_flag || (async != nullptr && async->failed()) ||
+           (sink != nullptr && sink->fail());
+}
+
+io_stats ostream::stats() const {
+    io_stats total = counters;
+    if (async != nullptr) {
+        io_stats queued = async->stats();
+        total.syscalls += queued.syscalls;
+        total.bytes += queued.bytes;
+    }
+    return total;
+}
+
+ostream& ostream::end_record() {
+    explicit_records = true;
+    record_end = buffer_pos;
+    return *this;
+}
+
+void ostream::HandOff(size_t size) {
+    if (size == 0) {
+        // No record is complete yet: make room instead of splitting one.
+        std::unique_ptr<char[]> larger(new char[2 * buffer_size]);
+        memcpy(larger.get(), buffer.get(), buffer_pos);
+        buffer = std::move(larger);
+        buffer_size *= 2;
+        return;
+    }
+    auto* item = new shared_writer::queue::chunk;
+    item->size = size;
+    item->written = &chunks_written;
+    item->data = std::move(buffer);
+    buffer.reset(new char[buffer_size]);
+    memcpy(buffer.get(), item->data.get() + size, buffer_pos - size);
+    buffer_pos -= size;
+    record_end = record_end > size ? record_end - size : 0;
+    ++chunks_sent;
+    sink->impl->push(item);
+}
+
+void ostream::enable_async(size_t buffer_count, bool use_io_uring) {
+    if (async == nullptr && sink == nullptr) {
+        async = std::make_unique<async_writer>(output_fd, buffer_size,
+                                               buffer_count, use_io_uring);
+    }
+}
+
+void ostream::disable_async() {
+    flush_buffer();
+    if (async != nullptr) {
+        async->wait_idle();
+        io_stats queued = async->stats();
+        counters.syscalls += queued.syscalls;
+        counters.bytes += queued.bytes;
+        async.reset();
+    }
+}
+
+bool ostream::is_async() const {
+    return async != nullptr;
+}
+
+bool ostream::uses_io_uring() const {
+    return async != nullptr && async->uses_io_uring();
+}
+
+void ostream::flush_buffer() {
+    if (buffer_pos == 0) {
+        return;
+    }
+    if (sink != nullptr) {
+        size_t size = record_end;
+        if (!explicit_records) {
+            const void* newline = memrchr(buffer.get(), '\n', buffer_pos);
+            size = newline == nullptr
+                       ? 0
+                       : static_cast<const char*>(newline) - buffer.get() + 1;
+        }
+        HandOff(size);
+        return;
+    }
+    if (async != nullptr) {
+        buffer = async->submit(std::move(buffer), buffer_pos);
+    } else {
+        if (!write_all(output_fd, buffer.get(), buffer_pos,
+                       counters.syscalls)) {
             fail_flag = true;
         }
-        buffer_pos = 0;
+        counters.bytes += buffer_pos;
+    }
+    buffer_pos = 0;
+}
+
+void ostream::write_varint_bits(uint64_t bits) {
+    char temp[10];
+    size_t len = 0;
+    while (bits >= 0x80) {
+        temp[len++] = static_cast<char>(bits | 0x80);
+        bits >>= 7;
+    }
+    temp[len++] = static_cast<char>(bits);
+    if (buffer_size - buffer_pos >= len) {
+        memcpy(buffer.get() + buffer_pos, temp, len);
+        buffer_pos += len;
+    } else {
+        write(temp, len);
     }
 }
 
+ostream& ostream::write(const char* str, size_t size) {
+    if (size > buffer_size - buffer_pos) {
+        flush_buffer();
+        // Writing around the queue would reorder output.
+        if (size >= buffer_size && async == nullptr && sink == nullptr) {
+            if (!write_all(output_fd, str, size, counters.syscalls)) {
+                fail_flag = true;
+            }
+            counters.bytes += size;
+            return *this;
+        }
+    }
+    while (size > buffer_size - buffer_pos) {
+        size_t chunk = buffer_size - buffer_pos;
+        memcpy(buffer.get() + buffer_pos, str, chunk);
+        buffer_pos += chunk;
+        str += chunk;
+        size -= chunk;
+        flush_buffer();
+    }
+    memcpy(buffer.get() + buffer_pos, str, size);
+    buffer_pos += size;
+    return *this;
+}
+
 template <typename T>
 ostream& ostream::WriteNumber(T value) {
+    using U = std::make_unsigned_t<T>;
+    U magnitude = static_cast<U>(value);
+    bool negative = false;
     if constexpr (std::is_signed_v<T>) {
-        if (value == std::numeric_limits<T>::min()) {
-            put('-');
-            T abs_value = -(value / 10);
-            WriteNumber(abs_value);
-            put('0' - (value % 10));
-            return *this;
-        }
         if (value < 0) {
-            put('-');
-            value = -value;
+            negative = true;
+            magnitude = U(0) - magnitude;
         }
     }
 
-    char temp[20];
-    int len = 0;
-    do {
-        temp[len++] = '0' + (value % 10);
-        value /= 10;
-    } while (value > 0);
+    // Sign plus the 20 digits of the largest 64-bit value.
+    if (buffer_size - buffer_pos < 21) {
+        flush_buffer();
+    }
+    // A tiny buffer, or a shared_writer stream still holding an unfinished
+    // record after the flush, may not have that much room.
+    if (buffer_size - buffer_pos < 21) {
+        char temp[21];
+        size_t len = 0;
+        if (negative) {
+            temp[len++] = '-';
+        }
+        size_t digits = count_digits(magnitude);
+        for (size_t i = len + digits; i > len; magnitude /= 10) {
+            temp[--i] = static_cast<char>('0' + magnitude % 10);
+        }
+        return write(temp, len + digits);
+    }
 
-    for (int i = len - 1; i >= 0; --i) {
-        put(temp[i]);
+    char* out = buffer.get() + buffer_pos;
+    if (negative) {
+        *out++ = '-';
+    }
+    char* end = out + count_digits(magnitude);
+    buffer_pos = end - buffer.get();
+    while (magnitude >= 100) {
+        const char* pair = digit_pairs + 2 * (magnitude % 100);
+        magnitude /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+    if (magnitude >= 10) {
+        *--end = digit_pairs[2 * magnitude + 1];
+        *--end = digit_pairs[2 * magnitude];
+    } else {
+        *--end = static_cast<char>('0' + magnitude);
     }
     return *this;
 }
@@ -250,14 +1221,45 @@ ostream& ostream::operator<<(unsigned int value) {
     return WriteNumber<unsigned int>(value);
 }
 
+template <typename T>
+std::to_chars_result ostream::FormatReal(char* begin, char* end,
+                                         T value) const {
+    if (float_precision < 0) {
+        if (float_format == float_notation::general) {
+            return std::to_chars(begin, end, value);
+        }
+        return std::to_chars(begin, end, value,
+                             float_format == float_notation::fixed
+                                 ? std::chars_format::fixed
+                                 : std::chars_format::scientific);
+    }
+    std::chars_format format = std::chars_format::general;
+    if (float_format == float_notation::fixed) {
+        format = std::chars_format::fixed;
+    } else if (float_format == float_notation::scientific) {
+        format = std::chars_format::scientific;
+    }
+    return std::to_chars(begin, end, value, format, float_precision);
+}
+
 template <typename T>
 ostream& ostream::WriteReal(T value) {
-    char temp[64];
-    int len = snprintf(temp, sizeof(temp), "%.6f", value);
-    for (int i = 0; i < len; ++i) {
-        put(temp[i]);
+    // Format straight into the buffer, flushing once if the tail is short.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        std::to_chars_result result = FormatReal(
+            buffer.get() + buffer_pos, buffer.get() + buffer_size, value);
+        if (result.ec == std::errc()) {
+            buffer_pos = result.ptr - buffer.get();
+            return *this;
+        }
+        flush_buffer();
     }
-    return *this;
+    // Longer than the whole buffer: fixed notation of a huge value or a
+    // large precision. 400 covers the integer digits of any double.
+    std::vector<char> temp(400 + std::max(float_precision, 0));
+    std::to_chars_result result =
+        FormatReal(temp.data(), temp.data() + temp.size(), value);
+    return write(temp.data(), result.ptr - temp.data());
 }
 
 ostream& ostream::operator<<(double value) {
@@ -279,19 +1281,53 @@ ostream& ostream::operator<<(bool value) {
 }
 
 ostream& ostream::operator<<(const char* str) {
-    while (*str) {
-        put(*str++);
-    }
+    return write(str, strlen(str));
+}
+
+ostream& ostream::operator<<(ostream& (*manipulator)(ostream&)) {
+    return manipulator(*this);
+}
+
+ostream& ostream::operator<<(setprecision manipulator) {
+    float_precision = manipulator.digits;
     return *this;
 }
 
+ostream::float_notation ostream::notation() const {
+    return float_format;
+}
+
+void ostream::notation(float_notation value) {
+    float_format = value;
+}
+
+int ostream::precision() const {
+    return float_precision;
+}
+
+void ostream::precision(int value) {
+    float_precision = value;
+}
+
+ostream& fixed(ostream& os) {
+    os.notation(ostream::float_notation::fixed);
+    return os;
+}
+
+ostream& scientific(ostream& os) {
+    os.notation(ostream::float_notation::scientific);
+    return os;
+}
+
+ostream& defaultfloat(ostream& os) {
+    os.notation(ostream::float_notation::general);
+    return os;
+}
+
 ostream& ostream::operator<<(const void* ptr) {
-    char buffer[20];
-    int len = snprintf(buffer, sizeof(buffer), "%p", ptr);
-    for (int i = 0; i < len; ++i) {
-        put(buffer[i]);
-    }
-    return *this;
+    char temp[20];
+    int len = snprintf(temp, sizeof(temp), "%p", ptr);
+    return write(temp, len);
 }
 
 void ostream::put(char curr) {
@@ -302,6 +1338,16 @@ void ostream::put(char curr) {
 }
 
 void ostream::flush() {
+    if (sink != nullptr) {
+        if (buffer_pos > 0) {
+            HandOff(buffer_pos);
+        }
+        sink->impl->wait_written(chunks_written, chunks_sent);
+        return;
+    }
     flush_buffer();
+    if (async != nullptr) {
+        async->wait_idle();
+    }
 }
 }  // namespace stdlike
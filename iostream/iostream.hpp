@@ -0,0 +1,395 @@
+#pragma once
+
+#include <unistd.h>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace stdlike {
+
+class istream;
+class ostream;
+class async_writer;
+class shared_writer;
+struct setprecision;
+
+// How read_array/write_array lay out integers: fixed-width little-endian
+// bytes, or LEB128 varints with signed values zigzag-mapped first, so small
+// magnitudes of either sign take one or two bytes.
+enum class binary_encoding { raw, varint };
+
+// What a stream has asked of the kernel since construction: read, write
+// and mmap calls, and the bytes they moved. Comparing bytes per syscall
+// across buffer sizes and modes shows what the buffering buys.
+struct io_stats {
+    uint64_t syscalls = 0;
+    uint64_t bytes = 0;
+};
+
+extern istream cin;
+extern ostream cout;
+
+class istream {
+public:
+    static constexpr size_t default_buffer_size = 1 << 16;
+
+    bool fail() const;
+    istream(ostream& output_stream);
+    // Reads from fd, which stays owned by the caller.
+    istream(ostream& output_stream, int fd,
+            size_t buffer_size = default_buffer_size);
+    istream(const istream&) = delete;
+    istream& operator=(const istream&) = delete;
+    ~istream();
+    istream& operator>>(unsigned long long& value);
+    istream& operator>>(int& value);
+    istream& operator>>(long long& value);
+    istream& operator>>(unsigned int& value);
+    istream& operator>>(double& value);
+    istream& operator>>(float& value);
+    istream& operator>>(char& value);
+    istream& operator>>(bool& value);
+
+    char get();
+    void unget();
+    void put(char c);
+    char peek();
+
+    // The next whitespace-delimited token, or the rest of the line without
+    // its '\n'. The view points into the buffer or mapping and stays valid
+    // until the next read; only a token cut by a refill is copied. Nothing
+    // left to read sets fail and returns an empty view.
+    std::string_view read_token();
+    std::string_view read_line();
+
+    // Binary input in the layout the ostream counterparts write. Input
+    // ending early sets fail.
+    bool read_bytes(char* out, size_t size);
+    template <typename T>
+    istream& read_pod(T& value);
+    template <typename T>
+    istream& read_varint(T& value);
+    template <typename T>
+    istream& read_array(std::span<T> values,
+                        binary_encoding encoding = binary_encoding::raw);
+
+    int fd() const;
+    // Tells the kernel the input will be read front to back, so it can use
+    // a larger readahead window. Returns false if the fd does not support
+    // it (pipes, ttys).
+    bool advise_sequential();
+    // Maps the rest of a regular file into memory and parses straight from
+    // the mapping. Returns false and keeps reading through the buffer for
+    // pipes, ttys and anything else that cannot be mapped.
+    bool map_input();
+    bool mapped() const;
+    io_stats stats() const;
+
+    // The stream flushed before each refill that may wait on the other end
+    // of a tty, pipe or socket, so prompts are visible before the read
+    // blocks. Regular files never trigger a flush. tie(nullptr) unties and
+    // returns the previous tie.
+    ostream* tie() const;
+    ostream* tie(ostream* output_stream);
+
+private:
+    int input_fd;
+    size_t buffer_size;
+    std::unique_ptr<char[]> buffer;
+    // Either buffer.get() or the mapping; [buffer_pos, buffer_end) of it is
+    // still unread.
+    const char* data;
+    size_t buffer_pos;
+    size_t buffer_end;
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+
+    template <typename T>
+    istream& ReadNumber(T& value);
+    // Consumes the digits at buffer_pos, eight per step while the window
+    // holds that many. Returns false if the window ran out mid-number.
+    template <typename T>
+    bool ScanDigits(T& value, bool& overflow);
+    void skip_whitespace();
+    template <typename T>
+    istream& ReadReal(T& value);
+    // Characters from buffer_pos that could belong to a real, counting at
+    // most max_real_length + 1.
+    size_t real_length() const;
+    // Far longer than any real a program writes, short enough that a long
+    // word or blob in mixed input cannot grow the buffer without bound.
+    static constexpr size_t max_real_length = 4096;
+    // Consumes up to the first position find(begin, end) reports, gathering
+    // across refills into spill when the window ends first.
+    template <typename Find>
+    std::string_view ReadUntil(Find find);
+    std::string spill;
+    bool read_varint_bits(uint64_t& bits);
+    bool fill_buffer();
+    // Reads more input after the unread bytes, moving them to the front of
+    // the buffer first and growing it if they fill it. False at end of input
+    // and in mapped mode.
+    bool extend_window();
+    // One read(2) into out after flushing the tie if the input may block;
+    // retries EINTR and counts the call.
+    ssize_t read_input(char* out, size_t size);
+    void clear_buffer();
+    io_stats counters;
+    bool fail_flag = false;
+    bool blocking_input;
+    ostream* tied_stream;
+};
+
+class ostream {
+public:
+    static constexpr size_t default_buffer_size = 1 << 16;
+
+    ostream();
+    // Writes to fd, which stays owned by the caller.
+    explicit ostream(int fd, size_t buffer_size = default_buffer_size);
+    // Formats into a private buffer and hands whole records to sink, whose
+    // thread writes them, so streams used from different threads never
+    // interleave inside a record. A record ends with a newline until
+    // end_record() is first called; from then on only its marks count. A
+    // record longer than the buffer grows the buffer rather than split.
+    explicit ostream(shared_writer& sink,
+                     size_t buffer_size = default_buffer_size);
+    ostream(const ostream&) = delete;
+    ostream& operator=(const ostream&) = delete;
+    ~ostream();
+    bool fail() const;
+    ostream& operator<<(int value);
+    ostream& operator<<(long long value);
+    ostream& operator<<(unsigned long long value);
+    ostream& operator<<(unsigned int value);
+    ostream& operator<<(double value);
+    ostream& operator<<(float value);
+    ostream& operator<<(char value);
+    ostream& operator<<(bool value);
+    ostream& operator<<(const char* str);
+    ostream& operator<<(const void* ptr);
+    ostream& operator<<(ostream& (*manipulator)(ostream&));
+    ostream& operator<<(setprecision manipulator);
+
+    // How doubles and floats are printed. By default (general notation, no
+    // precision) the shortest text that reads back to the same value is
+    // written; a precision fixes the digit count as printf would.
+    enum class float_notation { general, fixed, scientific };
+    float_notation notation() const;
+    void notation(float_notation value);
+    // Digits after the point (fixed, scientific) or significant digits
+    // (general); negative selects the shortest round-trip form.
+    int precision() const;
+    void precision(int value);
+
+    void put(char c);
+    // Copies size bytes into the buffer; payloads at least as large as the
+    // buffer go to the fd directly once the pending bytes are flushed.
+    ostream& write(const char* str, size_t size);
+    template <typename T>
+    ostream& write_pod(const T& value);
+    template <typename T>
+    ostream& write_varint(T value);
+    template <typename T>
+    ostream& write_array(std::span<const T> values,
+                         binary_encoding encoding = binary_encoding::raw);
+    void flush();
+    int fd() const;
+    ostream& end_record();
+    // Includes writes made by the async writer thread; a shared_writer
+    // keeps its own.
+    io_stats stats() const;
+
+    // Hands full buffers off to be written asynchronously, so formatting
+    // only waits when all buffer_count buffers are in flight. Writes go
+    // through io_uring when the kernel allows it (and use_io_uring is set),
+    // otherwise through a background writer thread. flush() still returns
+    // once everything queued has reached the fd.
+    void enable_async(size_t buffer_count = 2, bool use_io_uring = true);
+    void disable_async();
+    bool is_async() const;
+    bool uses_io_uring() const;
+
+private:
+    std::unique_ptr<async_writer> async;
+    int output_fd;
+    size_t buffer_size;
+    std::unique_ptr<char[]> buffer;
+
+    template <typename T>
+    ostream& WriteNumber(T value);
+    template <typename T>
+    ostream& WriteReal(T value);
+    template <typename T>
+    std::to_chars_result FormatReal(char* begin, char* end, T value) const;
+    size_t buffer_pos;
+    float_notation float_format = float_notation::general;
+    int float_precision = -1;
+
+    shared_writer* sink = nullptr;
+    size_t record_end = 0;
+    bool explicit_records = false;
+    uint64_t chunks_sent = 0;
+    std::atomic<uint64_t> chunks_written{0};
+    void HandOff(size_t size);
+    void write_varint_bits(uint64_t bits);
+
+    io_stats counters;
+    bool fail_flag = false;
+    void flush_buffer();
+};
+
+// Owns the one thread that writes whatever the ostreams bound to it hand
+// off. Handoff goes through a lock-free queue, so producers never wait on
+// each other or on the fd. Bound streams must be destroyed first.
+class shared_writer {
+public:
+    explicit shared_writer(int fd = STDOUT_FILENO);
+    shared_writer(const shared_writer&) = delete;
+    shared_writer& operator=(const shared_writer&) = delete;
+    ~shared_writer();
+    int fd() const;
+    bool fail() const;
+    io_stats stats() const;
+
+private:
+    friend class ostream;
+    struct queue;
+    std::unique_ptr<queue> impl;
+};
+
+namespace detail {
+
+// Arithmetic values travel little-endian; other trivially copyable types
+// are moved as they sit in memory.
+template <typename T>
+T to_little_endian(T value) {
+    if constexpr (std::endian::native == std::endian::big &&
+                  std::is_arithmetic_v<T> && sizeof(T) > 1) {
+        char* bytes = reinterpret_cast<char*>(&value);
+        for (size_t i = 0; i < sizeof(T) / 2; ++i) {
+            std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+        }
+    }
+    return value;
+}
+
+template <typename T>
+constexpr bool bulk_copyable = std::endian::native == std::endian::little ||
+                               !std::is_arithmetic_v<T> || sizeof(T) == 1;
+
+}  // namespace detail
+
+template <typename T>
+istream& istream::read_pod(T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (read_bytes(reinterpret_cast<char*>(&value), sizeof(T))) {
+        value = detail::to_little_endian(value);
+    }
+    return *this;
+}
+
+template <typename T>
+istream& istream::read_varint(T& value) {
+    static_assert(std::is_integral_v<T>);
+    using U = std::make_unsigned_t<T>;
+    uint64_t bits;
+    if (!read_varint_bits(bits)) {
+        return *this;
+    }
+    if (bits > std::numeric_limits<U>::max()) {
+        fail_flag = true;
+        return *this;
+    }
+    U raw = static_cast<U>(bits);
+    if constexpr (std::is_signed_v<T>) {
+        raw = (raw >> 1) ^ (U(0) - (raw & 1));
+    }
+    value = static_cast<T>(raw);
+    return *this;
+}
+
+template <typename T>
+istream& istream::read_array(std::span<T> values, binary_encoding encoding) {
+    if (encoding == binary_encoding::varint) {
+        if constexpr (std::is_integral_v<T>) {
+            for (T& value : values) {
+                read_varint(value);
+            }
+        } else {
+            fail_flag = true;
+        }
+    } else if constexpr (detail::bulk_copyable<T>) {
+        read_bytes(reinterpret_cast<char*>(values.data()), values.size_bytes());
+    } else {
+        for (T& value : values) {
+            read_pod(value);
+        }
+    }
+    return *this;
+}
+
+template <typename T>
+ostream& ostream::write_pod(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T little = detail::to_little_endian(value);
+    return write(reinterpret_cast<const char*>(&little), sizeof(T));
+}
+
+template <typename T>
+ostream& ostream::write_varint(T value) {
+    static_assert(std::is_integral_v<T>);
+    using U = std::make_unsigned_t<T>;
+    U raw = static_cast<U>(value);
+    if constexpr (std::is_signed_v<T>) {
+        raw = (raw << 1) ^ (U(0) - (raw >> (8 * sizeof(T) - 1)));
+    }
+    write_varint_bits(raw);
+    return *this;
+}
+
+template <typename T>
+ostream& ostream::write_array(std::span<const T> values,
+                              binary_encoding encoding) {
+    if (encoding == binary_encoding::varint) {
+        if constexpr (std::is_integral_v<T>) {
+            for (T value : values) {
+                write_varint(value);
+            }
+        } else {
+            fail_flag = true;
+        }
+    } else if constexpr (detail::bulk_copyable<T>) {
+        write(reinterpret_cast<const char*>(values.data()),
+              values.size_bytes());
+    } else {
+        for (const T& value : values) {
+            write_pod(value);
+        }
+    }
+    return *this;
+}
+
+struct setprecision {
+    explicit setprecision(int digits) : digits(digits) {
+    }
+    int digits;
+};
+
+ostream& fixed(ostream& os);
+ostream& scientific(ostream& os);
+ostream& defaultfloat(ostream& os);
+
+extern istream cin;
+extern ostream cout;
+
+}  // namespace stdlike
@@ -0,0 +1,162 @@
+// Regression checks for stdlike streams. Build from this directory:
+//   g++ -std=c++20 -O1 -fsanitize=address,undefined -pthread
+//       iostream_test.cpp iostream.cpp -o iostream_test
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "iostream.hpp"
+
+namespace {
+
+std::string temp_path(const char* name) {
+    return std::string("/tmp/stdlike_") + name + "_" +
+           std::to_string(getpid());
+}
+
+std::string read_file(const std::string& path) {
+    std::string contents;
+    int fd = open(path.c_str(), O_RDONLY);
+    char chunk[4096];
+    ssize_t bytes_read;
+    while ((bytes_read = read(fd, chunk, sizeof(chunk))) > 0) {
+        contents.append(chunk, bytes_read);
+    }
+    close(fd);
+    return contents;
+}
+
+// A shared_writer stream flushes only up to the last record, so the number
+// formatter must not assume the flush left it 21 free bytes.
+void test_number_after_partial_record_flush() {
+    std::string path = temp_path("record");
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    std::string expected = "a\n" + std::string(60, 'x') +
+                           "-1234567890123456789\n";
+    {
+        stdlike::shared_writer writer(fd);
+        stdlike::ostream out(writer, 64);
+        out << "a\n";
+        for (int i = 0; i < 60; ++i) {
+            out.put('x');
+        }
+        out << -1234567890123456789LL << '\n';
+    }
+    close(fd);
+    assert(read_file(path) == expected);
+    unlink(path.c_str());
+}
+
+std::string write_temp(const char* name, const std::string& contents) {
+    std::string path = temp_path(name);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    assert(write(fd, contents.data(), contents.size()) ==
+           static_cast<ssize_t>(contents.size()));
+    close(fd);
+    return path;
+}
+
+// A real stops where from_chars stops, whether or not the token crossed a
+// refill and whether or not the input is mapped.
+void test_real_consumes_same_prefix_in_every_mode() {
+    std::string path = write_temp("real", "12abc 7");
+    for (size_t buffer_size : {1, 3, 4, 65536}) {
+        for (bool map : {false, true}) {
+            int fd = open(path.c_str(), O_RDONLY);
+            {
+                stdlike::istream in(stdlike::cout, fd, buffer_size);
+                assert(!map || in.map_input());
+                double number = 0;
+                char next = 0;
+                in >> number >> next;
+                assert(number == 12 && next == 'a' && !in.fail());
+            }
+            close(fd);
+        }
+    }
+    unlink(path.c_str());
+}
+
+// A long run of letters where a real is expected fails once it passes the
+// cap instead of pulling the whole run into the buffer.
+void test_real_stops_growing_on_long_runs() {
+    std::string path = write_temp("long_real", "1" + std::string(1 << 17, 'z'));
+    for (bool map : {false, true}) {
+        int fd = open(path.c_str(), O_RDONLY);
+        {
+            stdlike::istream in(stdlike::cout, fd, 16);
+            assert(!map || in.map_input());
+            double number = 0;
+            in >> number;
+            assert(in.fail());
+            assert(map || in.stats().bytes < 4 * 4096);
+        }
+        close(fd);
+    }
+    unlink(path.c_str());
+}
+
+// Both async backends must deliver buffers in order and complete on flush.
+void test_async_output_in_order() {
+    std::string path = temp_path("async");
+    for (bool use_io_uring : {true, false}) {
+        std::string expected;
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        {
+            stdlike::ostream out(fd, 16);
+            out.enable_async(3, use_io_uring);
+            for (int i = 0; i < 10000; ++i) {
+                out << i << ' ';
+                expected += std::to_string(i) + ' ';
+            }
+            out.flush();
+            assert(read_file(path) == expected && !out.fail());
+        }
+        close(fd);
+    }
+    unlink(path.c_str());
+}
+
+// A binary read too large for the buffer goes to the fd directly, and must
+// still flush the tie first: the peer only answers once it sees the prompt.
+void test_direct_read_flushes_tie() {
+    int requests[2];
+    int replies[2];
+    assert(pipe(requests) == 0 && pipe(replies) == 0);
+    bool prompt_seen = false;
+    std::thread peer([&] {
+        pollfd ready{requests[0], POLLIN, 0};
+        char prompt[8];
+        prompt_seen = poll(&ready, 1, 2000) == 1 &&
+                      read(requests[0], prompt, sizeof(prompt)) == 2;
+        std::string payload(64, 'p');
+        assert(write(replies[1], payload.data(), payload.size()) == 64);
+    });
+    {
+        stdlike::ostream out(requests[1]);
+        stdlike::istream in(out, replies[0], 16);
+        char payload[64];
+        out << "?\n";
+        assert(in.read_bytes(payload, sizeof(payload)));
+    }
+    peer.join();
+    assert(prompt_seen);
+    for (int fd : {requests[0], requests[1], replies[0], replies[1]}) {
+        close(fd);
+    }
+}
+
+}  // namespace
+
+int main() {
+    test_number_after_partial_record_flush();
+    test_real_consumes_same_prefix_in_every_mode();
+    test_real_stops_growing_on_long_runs();
+    test_async_output_in_order();
+    test_direct_read_flushes_tie();
+    puts("OK");
+}
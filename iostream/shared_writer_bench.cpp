@@ -0,0 +1,131 @@
+// Scales concurrent writers from 1 to 32 threads. Each thread prints its
+// share of a fixed number of lines either through its own ostream bound to
+// one shared_writer, or through a single ostream behind a global mutex. Build
+// from this directory and run with an optional total line count (default
+// 10000000):
+//   g++ -std=c++20 -O2 -pthread shared_writer_bench.cpp iostream.cpp
+//       -o shared_writer_bench
+//   ./shared_writer_bench 10000000
+//
+// Output goes to a temporary file, and each run checks that every line
+// arrived whole: a torn record would change the line count or length.
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iostream.hpp"
+
+namespace {
+
+// "w<thread> <7 digits> <10 digits>\n" with a two-digit thread number, so
+// every line has the same length and a torn one shows in the file size.
+void print_line(stdlike::ostream& out, int thread, long long index) {
+    long long value = index % 1000000 + 1000000;
+    out << (thread < 10 ? "w0" : "w") << thread << ' ' << value << ' '
+        << value * 1000 << '\n';
+}
+
+constexpr size_t kLineSize = 3 + 1 + 7 + 1 + 10 + 1;
+
+struct result {
+    double seconds;
+    stdlike::io_stats stats;
+};
+
+template <typename Run>
+result timed(Run run) {
+    auto start = std::chrono::steady_clock::now();
+    stdlike::io_stats stats = run();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return {elapsed.count(), stats};
+}
+
+result run_shared_writer(int fd, int threads, long long lines) {
+    return timed([&] {
+        stdlike::shared_writer writer(fd);
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < threads; ++thread) {
+            workers.emplace_back([&writer, thread, threads, lines] {
+                stdlike::ostream out(writer);
+                for (long long i = thread; i < lines; i += threads) {
+                    print_line(out, thread, i);
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        return writer.stats();
+    });
+}
+
+result run_mutex(int fd, int threads, long long lines) {
+    return timed([&] {
+        stdlike::ostream out(fd);
+        std::mutex lock;
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < threads; ++thread) {
+            workers.emplace_back([&out, &lock, thread, threads, lines] {
+                for (long long i = thread; i < lines; i += threads) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    print_line(out, thread, i);
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        out.flush();
+        return out.stats();
+    });
+}
+
+bool whole_lines(int fd, long long lines) {
+    if (lseek(fd, 0, SEEK_END) != static_cast<off_t>(lines * kLineSize)) {
+        return false;
+    }
+    lseek(fd, 0, SEEK_SET);
+    std::vector<char> chunk(kLineSize * 4096);
+    ssize_t bytes_read;
+    while ((bytes_read = read(fd, chunk.data(), chunk.size())) > 0) {
+        for (ssize_t i = kLineSize - 1; i < bytes_read; i += kLineSize) {
+            if (chunk[i] != '\n') {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    long long lines = argc > 1 ? std::strtoll(argv[1], nullptr, 10) : 10000000;
+    std::string path =
+        "/tmp/stdlike_shared_writer_bench_" + std::to_string(getpid());
+    std::printf("%lld lines of %zu bytes\n", lines, kLineSize);
+    std::printf("%-14s %7s %12s %9s %10s %10s\n", "mode", "threads",
+                "M lines/s", "MB/s", "syscalls", "intact");
+    for (int threads = 1; threads <= 32; threads *= 2) {
+        for (bool shared : {true, false}) {
+            int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            result run = shared ? run_shared_writer(fd, threads, lines)
+                                : run_mutex(fd, threads, lines);
+            std::printf("%-14s %7d %12.2f %9.1f %10llu %10s\n",
+                        shared ? "shared_writer" : "global mutex", threads,
+                        lines / run.seconds / 1e6,
+                        run.stats.bytes / run.seconds / 1e6,
+                        static_cast<unsigned long long>(run.stats.syscalls),
+                        whole_lines(fd, lines) ? "yes" : "NO");
+            close(fd);
+        }
+    }
+    unlink(path.c_str());
+}
@@ -0,0 +1,113 @@
+// Reads 10^7 integers while printing a result for each, the shape of an
+// interactive read/print loop. Input arrives through a pipe, so a tied
+// output stream is flushed before every refill that may block. Rows compare
+// the tied stream, an untied one, and a flush after every read (what tying
+// used to cost). Build from this directory and run with an optional count:
+//   g++ -std=c++20 -O2 -pthread tie_bench.cpp iostream.cpp -o tie_bench
+//   ./tie_bench 10000000
+#include <fcntl.h>
+#include <unistd.h>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "iostream.hpp"
+
+namespace {
+
+enum class mode { tied, untied, flush_every_read };
+
+struct result {
+    double seconds;
+    long long sum;
+    stdlike::io_stats input;
+    stdlike::io_stats output;
+};
+
+result run(const std::string& text, long long count, mode how) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        std::perror("pipe");
+        std::exit(1);
+    }
+    std::thread feeder([&text, fd = pipe_fds[1]] {
+        const char* data = text.data();
+        size_t left = text.size();
+        while (left > 0) {
+            ssize_t written = write(fd, data, left);
+            if (written <= 0) {
+                break;
+            }
+            data += written;
+            left -= written;
+        }
+        close(fd);
+    });
+
+    int null_fd = open("/dev/null", O_WRONLY);
+    result outcome{};
+    auto start = std::chrono::steady_clock::now();
+    {
+        stdlike::ostream out(null_fd);
+        stdlike::istream in(out, pipe_fds[0]);
+        if (how == mode::untied) {
+            in.tie(nullptr);
+        }
+        for (long long i = 0; i < count; ++i) {
+            int value;
+            in >> value;
+            if (how == mode::flush_every_read) {
+                out.flush();
+            }
+            outcome.sum += value;
+            out << 2LL * value << '\n';
+        }
+        out.flush();
+        outcome.input = in.stats();
+        outcome.output = out.stats();
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    outcome.seconds = elapsed.count();
+    feeder.join();
+    close(pipe_fds[0]);
+    close(null_fd);
+    return outcome;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    long long count = argc > 1 ? std::strtoll(argv[1], nullptr, 10) : 10000000;
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> any;
+    std::string text;
+    long long expected = 0;
+    char digits[16];
+    for (long long i = 0; i < count; ++i) {
+        int value = any(random);
+        expected += value;
+        text.append(digits, std::to_chars(digits, digits + 16, value).ptr);
+        text += '\n';
+    }
+
+    std::printf("%lld integers through a pipe, one result printed per read\n",
+                count);
+    std::printf("%-18s %9s %12s %12s %12s\n", "mode", "seconds",
+                "M values/s", "read calls", "write calls");
+    for (mode how : {mode::tied, mode::untied, mode::flush_every_read}) {
+        result outcome = run(text, count, how);
+        const char* name = how == mode::tied     ? "tied"
+                           : how == mode::untied ? "untied"
+                                                 : "flush every read";
+        std::printf("%-18s %9.3f %12.2f %12llu %12llu%s\n", name,
+                    outcome.seconds, count / outcome.seconds / 1e6,
+                    static_cast<unsigned long long>(outcome.input.syscalls),
+                    static_cast<unsigned long long>(outcome.output.syscalls),
+                    outcome.sum == expected ? "" : "  MISMATCH");
+    }
+}
@@ -0,0 +1,56 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+Arena::Arena(size_t initial_block)
+    : initial_block_(std::max(initial_block, sizeof(Block))),
+      next_block_(initial_block_) {}
+
+void* Arena::Allocate(size_t bytes, size_t alignment) {
+  uintptr_t pos = reinterpret_cast<uintptr_t>(pos_);
+  uintptr_t aligned = (pos + alignment - 1) & ~(alignment - 1);
+  if (pos_ == nullptr || aligned + bytes > reinterpret_cast<uintptr_t>(end_)) {
+    AddBlock(bytes, alignment);
+    pos = reinterpret_cast<uintptr_t>(pos_);
+    aligned = (pos + alignment - 1) & ~(alignment - 1);
+  }
+  pos_ = reinterpret_cast<char*>(aligned + bytes);
+  return reinterpret_cast<void*>(aligned);
+}
+
+bool Arena::TryExpand(void* ptr, size_t old_bytes, size_t new_bytes) {
+  char* begin = static_cast<char*>(ptr);
+  if (begin + old_bytes != pos_ ||
+      new_bytes - old_bytes > static_cast<size_t>(end_ - pos_)) {
+    return false;
+  }
+  pos_ = begin + new_bytes;
+  return true;
+}
+
+void Arena::AddBlock(size_t bytes, size_t alignment) {
+  size_t needed = sizeof(Block) + bytes + alignment;
+  size_t size = std::max(next_block_, needed);
+  Block* block = static_cast<Block*>(::operator new(size));
+  block->prev = head_;
+  block->size = size;
+  head_ = block;
+  pos_ = reinterpret_cast<char*>(block + 1);
+  end_ = reinterpret_cast<char*>(block) + size;
+  reserved_ += size;
+  next_block_ = std::max(next_block_, size) * 2;
+}
+
+void Arena::Release() {
+  while (head_ != nullptr) {
+    Block* prev = head_->prev;
+    ::operator delete(head_);
+    head_ = prev;
+  }
+  pos_ = nullptr;
+  end_ = nullptr;
+  reserved_ = 0;
+  next_block_ = initial_block_;
+}
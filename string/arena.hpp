@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+
+// Monotonic (bump-pointer) memory resource. Allocations are carved out of
+// geometrically growing blocks and are returned only all at once, by
+// Release() or the destructor; deallocating a single object is a no-op.
+// Not thread-safe: use one arena per request / per thread.
+class Arena {
+ public:
+  explicit Arena(size_t initial_block = 4096);
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  ~Arena() { Release(); };
+  void* Allocate(size_t bytes, size_t alignment);
+  // Grows the most recent allocation in place if the current block has
+  // room for it; returns false (and changes nothing) otherwise.
+  bool TryExpand(void* ptr, size_t old_bytes, size_t new_bytes);
+  void Release();
+  // Total size of the blocks currently owned by the arena.
+  size_t Reserved() const { return reserved_; };
+
+ private:
+  struct Block {
+    Block* prev;
+    size_t size;
+  };
+  void AddBlock(size_t bytes, size_t alignment);
+
+  Block* head_ = nullptr;
+  char* pos_ = nullptr;
+  char* end_ = nullptr;
+  size_t initial_block_;
+  size_t next_block_;
+  size_t reserved_ = 0;
+};
+
+// Standard allocator over an Arena, so BasicString, List and Deque can all
+// draw from the same arena. Copies compare equal when they share it.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ArenaAllocator(Arena& arena) : arena_(&arena){};
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_){};
+  T* allocate(size_t count) {
+    return static_cast<T*>(arena_->Allocate(count * sizeof(T), alignof(T)));
+  };
+  void deallocate(T* /*ptr*/, size_t /*count*/){};
+  bool expand(T* ptr, size_t old_count, size_t new_count) {
+    return arena_->TryExpand(ptr, old_count * sizeof(T),
+                             new_count * sizeof(T));
+  };
+  Arena& arena() const { return *arena_; };
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.arena_;
+  };
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return arena_ != other.arena_;
+  };
+
+ private:
+  template <typename U>
+  friend class ArenaAllocator;
+  Arena* arena_;
+};
@@ -0,0 +1,110 @@
+// Per-PushBack cost of building strings one char at a time, before and after
+// the integer growth policy and in-place expansion. "before" reproduces the
+// previous String: capacity from pow(2, ceil(log2(size))) and a copy into a
+// fresh buffer on every growth. Build from this directory, adding
+// -DSTRING_GROWTH_FACTOR_1_5 to measure the 1.5x policy instead of bit_ceil:
+//   g++ -std=c++20 -O2 -pthread growth_bench.cpp arena.cpp rope.cpp
+//       shared_string.cpp string.cpp string_hash.cpp string_search.cpp
+//       string_view.cpp -o growth_bench
+//   ./growth_bench
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "arena.hpp"
+#include "string.hpp"
+
+namespace {
+
+// The previous String, reduced to what PushBack touches. PushBack stays out
+// of line, as it was when it lived in string.cpp.
+class LegacyString {
+ public:
+  LegacyString() = default;
+  LegacyString(const LegacyString&) = delete;
+  LegacyString& operator=(const LegacyString&) = delete;
+  ~LegacyString() { delete[] str_; };
+  __attribute__((noinline)) void PushBack(char character) {
+    ++size_;
+    size_t capacity = capacity_;
+    CheckCapacity();
+    if (size_ != 1) {
+      if (capacity != capacity_) {
+        RealizeMemory(size_ - 1);
+      }
+    } else {
+      str_ = new char[1];
+    }
+    str_[size_ - 1] = character;
+  };
+  char Back() const { return str_[size_ - 1]; };
+  size_t Size() const { return size_; };
+
+ private:
+  void CheckCapacity() {
+    if (capacity_ < size_) {
+      capacity_ = pow(2, ceil(std::log2(size_)));
+    }
+  };
+  void RealizeMemory(size_t size) {
+    char* str = new char[capacity_];
+    std::copy(str_, str_ + size, str);
+    delete[] str_;
+    str_ = str;
+  };
+
+  size_t size_ = 0;
+  size_t capacity_ = 1;
+  char* str_ = nullptr;
+};
+
+// Builds rounds strings of length chars each; make() returns a fresh one.
+template <typename Make>
+double NanosPerPushBack(size_t length, size_t rounds, Make make) {
+  size_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < rounds; ++round) {
+    auto str = make();
+    for (size_t i = 0; i < length; ++i) {
+      str.PushBack(static_cast<char>('a' + (i + round) % 26));
+    }
+    checksum += str.Size() + str.Back();
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  if (checksum == 0) {
+    std::printf("unreachable\n");
+  }
+  return elapsed.count() / (length * rounds);
+}
+
+}  // namespace
+
+int main() {
+#ifdef STRING_GROWTH_FACTOR_1_5
+  const char* policy = "1.5x";
+#else
+  const char* policy = "bit_ceil";
+#endif
+  std::printf("ns per PushBack; after = %s growth\n", policy);
+  std::printf("%10s %10s %16s %18s %9s\n", "length", "before",
+              "after (new/copy)", "after (arena)", "speedup");
+  const size_t kTotal = size_t(1) << 26;
+  for (size_t length : {16, 64, 1024, 1 << 16, 1 << 20, 1 << 24}) {
+    size_t rounds = std::max<size_t>(kTotal / length, 1);
+    double before =
+        NanosPerPushBack(length, rounds, [] { return LegacyString(); });
+    double after = NanosPerPushBack(length, rounds, [] { return String(); });
+    // The arena is released every round, so each string starts from an
+    // empty block and its buffer can always grow in place at the end.
+    Arena arena;
+    using ArenaString = BasicString<ArenaAllocator<char>>;
+    double in_place = NanosPerPushBack(length, rounds, [&arena] {
+      arena.Release();
+      return ArenaString(ArenaAllocator<char>(arena));
+    });
+    std::printf("%10zu %10.2f %16.2f %18.2f %8.1fx\n", length, before, after,
+                in_place, before / std::min(after, in_place));
+  }
+}
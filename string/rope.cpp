@@ -0,0 +1,189 @@
+#include "rope.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+struct Rope::Node {
+  Text text;
+  size_t offset;
+  size_t length;
+  NodePtr left;
+  NodePtr right;
+  size_t size;
+  size_t pieces;
+};
+
+namespace {
+// True with probability lhs / (lhs + rhs).
+bool PickLeft(size_t lhs, size_t rhs) {
+  thread_local std::mt19937_64 generator(std::random_device{}());
+  return generator() % (lhs + rhs) < lhs;
+}
+}  // namespace
+
+Rope::NodePtr Rope::MakeNode(const Text& text, size_t offset, size_t length,
+                             NodePtr left, NodePtr right) {
+  size_t size = SizeOf(left) + length + SizeOf(right);
+  size_t pieces = PiecesOf(left) + 1 + PiecesOf(right);
+  return std::make_shared<const Node>(Node{text, offset, length,
+                                           std::move(left), std::move(right),
+                                           size, pieces});
+}
+Rope::NodePtr Rope::MakeLeaf(String&& str) {
+  size_t length = str.Size();
+  Text text = std::make_shared<const String>(std::move(str));
+  return MakeNode(text, 0, length, nullptr, nullptr);
+}
+size_t Rope::SizeOf(const NodePtr& node) {
+  return node == nullptr ? 0 : node->size;
+}
+size_t Rope::PiecesOf(const NodePtr& node) {
+  return node == nullptr ? 0 : node->pieces;
+}
+
+// Randomized merge and split by character position. Nodes are never
+// modified: every node on the affected path is rebuilt, the rest is shared.
+// Merge keeps the root of a side with probability proportional to its piece
+// count rather than comparing stored priorities, so a rope joined with
+// itself (or a copy or Substr of itself) stays balanced even though both
+// sides share every node.
+Rope::NodePtr Rope::Merge(const NodePtr& lhs, const NodePtr& rhs) {
+  if (lhs == nullptr) {
+    return rhs;
+  }
+  if (rhs == nullptr) {
+    return lhs;
+  }
+  if (PickLeft(lhs->pieces, rhs->pieces)) {
+    return MakeNode(lhs->text, lhs->offset, lhs->length, lhs->left,
+                    Merge(lhs->right, rhs));
+  }
+  return MakeNode(rhs->text, rhs->offset, rhs->length, Merge(lhs, rhs->left),
+                  rhs->right);
+}
+std::pair<Rope::NodePtr, Rope::NodePtr> Rope::Split(const NodePtr& node,
+                                                    size_t pos) {
+  if (node == nullptr) {
+    return {nullptr, nullptr};
+  }
+  size_t left_size = SizeOf(node->left);
+  if (pos <= left_size) {
+    auto [lhs, rhs] = Split(node->left, pos);
+    return {lhs, MakeNode(node->text, node->offset, node->length, rhs,
+                          node->right)};
+  }
+  pos -= left_size;
+  if (pos >= node->length) {
+    auto [lhs, rhs] = Split(node->right, pos - node->length);
+    return {MakeNode(node->text, node->offset, node->length, node->left, lhs),
+            rhs};
+  }
+  return {MakeNode(node->text, node->offset, pos, node->left, nullptr),
+          MakeNode(node->text, node->offset + pos, node->length - pos, nullptr,
+                   node->right)};
+}
+template <typename Visitor>
+void Rope::Visit(const NodePtr& node, Visitor& visit) {
+  if (node != nullptr) {
+    Visit(node->left, visit);
+    visit(StringView(node->text->Data() + node->offset, node->length));
+    Visit(node->right, visit);
+  }
+}
+
+Rope::Rope(StringView str) { Append(str); }
+Rope::Rope(String&& str) {
+  if (!str.Empty()) {
+    root_ = MakeLeaf(std::move(str));
+  }
+}
+
+void Rope::Commit() {
+  if (!tail_.Empty()) {
+    root_ = Merge(root_, MakeLeaf(std::move(tail_)));
+  }
+}
+size_t Rope::Size() const { return SizeOf(root_) + tail_.Size(); }
+char Rope::operator[](size_t ind) const {
+  const Node* node = root_.get();
+  if (ind >= SizeOf(root_)) {
+    return tail_[ind - SizeOf(root_)];
+  }
+  while (true) {
+    size_t left_size = SizeOf(node->left);
+    if (ind < left_size) {
+      node = node->left.get();
+    } else if (ind - left_size < node->length) {
+      return (*node->text)[node->offset + ind - left_size];
+    } else {
+      ind -= left_size + node->length;
+      node = node->right.get();
+    }
+  }
+}
+
+Rope& Rope::Append(StringView str) {
+  if (str.Empty()) {
+    return *this;
+  }
+  if (tail_.Size() + str.Size() > kChunk) {
+    Commit();
+  }
+  if (str.Size() >= kChunk) {
+    root_ = Merge(root_, MakeLeaf(String(str)));
+    return *this;
+  }
+  size_t size = tail_.Size();
+  tail_.Reserve(kChunk);
+  tail_.Resize(size + str.Size());
+  memcpy(tail_.Data() + size, str.Data(), str.Size());
+  return *this;
+}
+Rope& Rope::operator+=(const Rope& other) {
+  Commit();
+  root_ = Merge(root_, other.root_);
+  tail_ = other.tail_;
+  return *this;
+}
+Rope Rope::operator+(const Rope& other) const {
+  Rope result = *this;
+  result += other;
+  return result;
+}
+
+Rope Rope::Substr(size_t pos, size_t count) const {
+  Rope result;
+  size_t size = Size();
+  pos = std::min(pos, size);
+  count = std::min(count, size - pos);
+  size_t tree = SizeOf(root_);
+  if (pos < tree) {
+    NodePtr suffix = Split(root_, pos).second;
+    result.root_ = Split(suffix, std::min(count, tree - pos)).first;
+  }
+  if (pos + count > tree) {
+    size_t begin = std::max(pos, tree) - tree;
+    result.Append(StringView(tail_.Data() + begin, pos + count - tree - begin));
+  }
+  return result;
+}
+
+String Rope::Flatten() const {
+  String result;
+  result.Resize(Size());
+  char* out = result.Data();
+  auto copy = [&out](StringView piece) {
+    memcpy(out, piece.Data(), piece.Size());
+    out += piece.Size();
+  };
+  Visit(root_, copy);
+  copy(tail_);
+  return result;
+}
+
+std::ostream& operator<<(std::ostream& os, const Rope& rope) {
+  auto write = [&os](StringView piece) { os << piece; };
+  Rope::Visit(rope.root_, write);
+  return os << StringView(rope.tail_);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <utility>
+
+#include "string.hpp"
+
+// Text stored as a tree of pieces for building large documents. Pieces are
+// immutable and shared, so copies are O(1) and concatenation and substring
+// are O(log n) expected. Short appends are gathered into a tail chunk, so
+// Append is amortized O(1) per character. Flatten() builds a contiguous
+// String only on request; operator<< streams piece by piece without it.
+class Rope {
+ public:
+  Rope() = default;
+  explicit Rope(StringView str);
+  explicit Rope(String&& str);
+  size_t Size() const;
+  bool Empty() const { return Size() == 0; };
+  char operator[](size_t ind) const;
+  Rope& Append(StringView str);
+  Rope& operator+=(StringView str) { return Append(str); };
+  Rope& operator+=(const Rope& other);
+  Rope operator+(const Rope& other) const;
+  Rope Substr(size_t pos, size_t count = String::kNpos) const;
+  String Flatten() const;
+
+  friend std::ostream& operator<<(std::ostream& os, const Rope& rope);
+
+ private:
+  struct Node;
+  using NodePtr = std::shared_ptr<const Node>;
+  using Text = std::shared_ptr<const String>;
+
+  static NodePtr MakeNode(const Text& text, size_t offset, size_t length,
+                          NodePtr left, NodePtr right);
+  static NodePtr MakeLeaf(String&& str);
+  static size_t SizeOf(const NodePtr& node);
+  static size_t PiecesOf(const NodePtr& node);
+  static NodePtr Merge(const NodePtr& lhs, const NodePtr& rhs);
+  static std::pair<NodePtr, NodePtr> Split(const NodePtr& node, size_t pos);
+  template <typename Visitor>
+  static void Visit(const NodePtr& node, Visitor& visit);
+  void Commit();
+
+  // Appends shorter than kChunk are collected in tail_ and enter the tree
+  // as a single piece once it fills up.
+  static constexpr size_t kChunk = 4096;
+  NodePtr root_;
+  String tail_;
+};
+
+std::ostream& operator<<(std::ostream& os, const Rope& rope);
@@ -0,0 +1,96 @@
+#include "shared_string.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+namespace {
+// The intern table is split into independently locked shards picked by
+// hash, so threads interning different strings rarely contend.
+struct InternShard {
+  std::mutex mutex;
+  std::unordered_map<StringView, SharedString> strings;
+};
+const size_t kInternShards = 16;
+
+InternShard& ShardFor(uint64_t hash) {
+  static InternShard shards[kInternShards];
+  return shards[hash % kInternShards];
+}
+
+uint64_t EmptyHash() {
+  static const uint64_t kEmptyHash = HashBytes("", 0);
+  return kEmptyHash;
+}
+}  // namespace
+
+SharedString::SharedString(StringView str) {
+  if (str.Empty()) {
+    return;
+  }
+  void* memory = ::operator new(sizeof(Rep) + str.Size());
+  rep_ = new (memory) Rep{{1}, str.Size(), HashBytes(str.Data(), str.Size()),
+                          false};
+  memcpy(reinterpret_cast<char*>(rep_ + 1), str.Data(), str.Size());
+}
+SharedString::SharedString(const SharedString& other) noexcept
+    : rep_(other.rep_) {
+  if (rep_ != nullptr) {
+    rep_->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+SharedString& SharedString::operator=(const SharedString& other) noexcept {
+  SharedString copy(other);
+  std::swap(rep_, copy.rep_);
+  return *this;
+}
+SharedString& SharedString::operator=(SharedString&& other) noexcept {
+  std::swap(rep_, other.rep_);
+  return *this;
+}
+void SharedString::Unref() {
+  if (rep_ != nullptr &&
+      rep_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    rep_->~Rep();
+    ::operator delete(rep_);
+  }
+  rep_ = nullptr;
+}
+
+const char* SharedString::Data() const {
+  return rep_ == nullptr ? "" : reinterpret_cast<const char*>(rep_ + 1);
+}
+uint64_t SharedString::Hash() const {
+  return rep_ == nullptr ? EmptyHash() : rep_->hash;
+}
+bool SharedString::operator==(const SharedString& other) const {
+  if (rep_ == other.rep_) {
+    return true;
+  }
+  if (IsInterned() && other.IsInterned()) {
+    return false;
+  }
+  return Hash() == other.Hash() && StringView(*this) == StringView(other);
+}
+
+SharedString SharedString::Intern(StringView str) {
+  if (str.Empty()) {
+    return SharedString();
+  }
+  InternShard& shard = ShardFor(HashBytes(str.Data(), str.Size()));
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto found = shard.strings.find(str);
+  if (found != shard.strings.end()) {
+    return found->second;
+  }
+  SharedString interned(str);
+  interned.rep_->interned = true;
+  // The key views the interned buffer itself, which the table keeps alive.
+  shard.strings.emplace(interned, interned);
+  return interned;
+}
+
+std::ostream& operator<<(std::ostream& os, const SharedString& str) {
+  return os << StringView(str);
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+
+#include "string_view.hpp"
+
+// Immutable, reference-counted string. The characters, the count and the
+// hash live in one allocation; copies only bump an atomic counter, so they
+// are O(1) and may be shared freely between threads.
+//
+// Intern() returns the single process-wide instance for a given value;
+// interned strings compare equal iff they share a buffer, and stay alive
+// until the process exits.
+class SharedString {
+ public:
+  SharedString() = default;
+  explicit SharedString(StringView str);
+  SharedString(const SharedString& other) noexcept;
+  SharedString(SharedString&& other) noexcept : rep_(other.rep_) {
+    other.rep_ = nullptr;
+  };
+  SharedString& operator=(const SharedString& other) noexcept;
+  SharedString& operator=(SharedString&& other) noexcept;
+  ~SharedString() { Unref(); };
+  static SharedString Intern(StringView str);
+
+  size_t Size() const { return rep_ == nullptr ? 0 : rep_->size; };
+  bool Empty() const { return Size() == 0; };
+  const char* Data() const;
+  char operator[](size_t ind) const { return Data()[ind]; };
+  operator StringView() const { return StringView(Data(), Size()); };
+  // Computed once, when the string is created.
+  uint64_t Hash() const;
+  bool IsInterned() const { return rep_ != nullptr && rep_->interned; };
+  bool SharesBuffer(const SharedString& other) const {
+    return rep_ == other.rep_;
+  };
+  bool operator==(const SharedString& other) const;
+  bool operator!=(const SharedString& other) const {
+    return !(*this == other);
+  };
+
+ private:
+  struct Rep {
+    std::atomic<size_t> refs;
+    size_t size;
+    uint64_t hash;
+    bool interned;
+  };
+  void Unref();
+
+  Rep* rep_ = nullptr;
+};
+
+namespace std {
+template <>
+struct hash<SharedString> {
+  size_t operator()(const SharedString& str) const {
+    return static_cast<size_t>(str.Hash());
+  }
+};
+}  // namespace std
+
+std::ostream& operator<<(std::ostream& os, const SharedString& str);
@@ -0,0 +1,170 @@
+// Compares String::Split and SplitView, whose delimiter scan uses the SIMD
+// kernels picked at startup, with the scalar nested loop Split used before.
+// Build from this directory and run with an optional input size in MiB
+// (default 64):
+//   g++ -std=c++20 -O2 -pthread split_bench.cpp arena.cpp rope.cpp
+//       shared_string.cpp string.cpp string_hash.cpp string_search.cpp
+//       string_view.cpp -o split_bench
+//   ./split_bench 64
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "string.hpp"
+
+namespace {
+
+// The previous Split's scan: compare the delimiter at every index, byte by
+// byte, and hand each field to emit with the same collapsing rules.
+template <typename Emit>
+void ScalarFields(StringView str, StringView delim, Emit emit) {
+  size_t count = 0;
+  bool last_empty = false;
+  auto add_field = [&](size_t label_curr, size_t label) {
+    if (label_curr > label) {
+      emit(str.Substr(label, label_curr - label));
+      ++count;
+      last_empty = false;
+    } else if (count == 0 || !last_empty) {
+      emit(StringView());
+      ++count;
+      last_empty = true;
+    }
+  };
+  size_t label = 0;
+  size_t index = 0;
+  while (index < str.Size()) {
+    if (index + delim.Size() - 1 < str.Size()) {
+      bool found = true;
+      for (size_t j = index; j < index + delim.Size(); ++j) {
+        if (str[j] != delim[j - index]) {
+          found = false;
+          break;
+        }
+      }
+      if (found) {
+        add_field(index, label);
+        index += delim.Size() - 1;
+        label = index + 1;
+      }
+    }
+    if (index == str.Size() - 1 || index == str.Size()) {
+      add_field(index + 1, label);
+    }
+    ++index;
+  }
+  if (count == 1 && last_empty) {
+    emit(StringView());
+  } else if (count == 0) {
+    emit(str);
+  }
+}
+
+std::vector<String> ScalarSplit(StringView str, StringView delim) {
+  std::vector<String> result;
+  ScalarFields(str, delim,
+               [&](StringView field) { result.emplace_back(field); });
+  return result;
+}
+
+// Log-like lines: "<timestamp> | <level> | <words>\n".
+String MakeLog(size_t bytes) {
+  static const char* kWords[] = {"connect", "request", "GET", "/api/v1/items",
+                                 "200",     "latency", "ms",  "user=42",
+                                 "retry",   "cache",   "miss"};
+  static const char* kLevels[] = {"INFO", "WARN", "DEBUG"};
+  std::mt19937 random(7);
+  String log;
+  log.Reserve(bytes + 128);
+  while (log.Size() < bytes) {
+    log += String(std::to_string(random() % 100000000).c_str());
+    log += " | ";
+    log += kLevels[random() % 3];
+    log += " | ";
+    for (int words = random() % 8 + 3; words > 0; --words) {
+      log += kWords[random() % 11];
+      log += words > 1 ? " " : "\n";
+    }
+  }
+  return log;
+}
+
+size_t Checksum(const std::vector<String>& fields) {
+  size_t hash = fields.size();
+  for (const String& field : fields) {
+    hash = hash * 31 + std::hash<StringView>()(field);
+  }
+  return hash;
+}
+
+template <typename Body>
+double Seconds(Body body) {
+  auto start = std::chrono::steady_clock::now();
+  body();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void Report(const char* method, double seconds, size_t bytes, size_t fields,
+            double baseline) {
+  std::printf("  %-24s %9.3f %10.1f %12zu %8.1fx\n", method, seconds,
+              bytes / seconds / (1 << 20), fields, baseline / seconds);
+}
+
+void Bench(const String& log, StringView delim, const char* name) {
+  std::printf("delimiter %s\n", name);
+  std::printf("  %-24s %9s %10s %12s %9s\n", "method", "seconds", "MiB/s",
+              "fields", "speedup");
+  std::vector<String> scalar;
+  double baseline = Seconds([&] { scalar = ScalarSplit(log, delim); });
+  Report("scalar Split", baseline, log.Size(), scalar.size(), baseline);
+
+  String copy = log;
+  std::vector<String> fields;
+  double seconds = Seconds([&] { fields = copy.Split(delim); });
+  Report("Split", seconds, log.Size(), fields.size(), baseline);
+  if (Checksum(fields) != Checksum(scalar)) {
+    std::printf("  MISMATCH between Split and the scalar Split\n");
+  }
+
+  size_t scalar_count = 0;
+  size_t scalar_bytes = 0;
+  double scan_baseline = Seconds([&] {
+    ScalarFields(log, delim, [&](StringView field) {
+      ++scalar_count;
+      scalar_bytes += field.Size();
+    });
+  });
+  Report("scalar scan (no copies)", scan_baseline, log.Size(), scalar_count,
+         scan_baseline);
+
+  size_t count = 0;
+  size_t field_bytes = 0;
+  seconds = Seconds([&] {
+    for (StringView field : log.SplitView(delim)) {
+      ++count;
+      field_bytes += field.Size();
+    }
+  });
+  Report("SplitView (no copies)", seconds, log.Size(), count, scan_baseline);
+  if (count != scalar_count || field_bytes != scalar_bytes) {
+    std::printf("  MISMATCH between SplitView and the scalar scan\n");
+  }
+  std::printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t mebibytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+  String log = MakeLog(mebibytes << 20);
+  std::printf("%.1f MiB of log lines\n\n", log.Size() / double(1 << 20));
+  Bench(log, "\n", "'\\n' (single byte, long fields)");
+  Bench(log, " ", "' ' (single byte, short fields)");
+  Bench(log, " | ", "' | ' (multi-byte)");
+}
@@ -1,16 +1,53 @@
 #pragma once
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-class String {
+#include "string_search.hpp"
+#include "string_view.hpp"
+
+// Smallest power of two not less than value (value > 1).
+inline size_t BitCeil(size_t value) {
+  return static_cast<size_t>(1) << (64 - __builtin_clzll(value - 1));
+}
+
+// Allocators may offer expand(ptr, old_count, new_count): grow an
+// allocation in place and report whether that succeeded. BasicString tries
+// it before falling back to allocate-copy-deallocate.
+template <typename Alloc, typename = void>
+struct SupportsExpand : std::false_type {};
+template <typename Alloc>
+struct SupportsExpand<
+    Alloc, std::void_t<decltype(std::declval<Alloc&>().expand(
+               std::declval<char*>(), size_t(), size_t()))>>
+    : std::true_type {};
+
+template <typename Alloc = std::allocator<char>>
+class BasicString {
  public:
-  String();
-  String(size_t size, char character);
-  String(const char* str);
-  String(const String& str);
-  String& operator=(const String& str);
-  String& operator=(const char* str);
-  ~String() { delete[] str_; };
+  using value_type = char;
+  using allocator_type = Alloc;
+  static constexpr size_t kNpos = StringView::kNpos;
+  BasicString() = default;
+  explicit BasicString(const Alloc& alloc) : alloc_(alloc){};
+  BasicString(size_t size, char character, const Alloc& alloc = Alloc());
+  BasicString(const char* str, const Alloc& alloc = Alloc());
+  explicit BasicString(StringView str, const Alloc& alloc = Alloc());
+  BasicString(const BasicString& str);
+  BasicString(BasicString&& str) noexcept;
+  BasicString& operator=(const BasicString& str);
+  BasicString& operator=(BasicString&& str) noexcept(
+      std::allocator_traits<Alloc>::propagate_on_container_move_assignment::
+          value ||
+      std::allocator_traits<Alloc>::is_always_equal::value);
+  BasicString& operator=(const char* str);
+  ~BasicString() { Release(capacity_); };
+  allocator_type GetAllocator() const { return alloc_; };
   void Clear() { size_ = 0; };
   void PushBack(char character);
   void PopBack();
@@ -18,7 +55,7 @@ class String {
   void Resize(size_t new_size, char character);
   void Reserve(size_t new_cap);
   void ShrinkToFit();
-  void Swap(String& other);
+  void Swap(BasicString& other);
   char& operator[](int ind) { return *(str_ + ind); };
   char operator[](int ind) const { return *(str_ + ind); };
   char Front() const { return str_[0]; };
@@ -30,28 +67,586 @@ class String {
   size_t Capacity() const { return capacity_; };
   const char* Data() const { return str_; };
   char* Data() { return str_; };
-  bool operator==(const String& str) const;
-  bool operator!=(const String& str) const { return !(str == *(this)); }
-  bool operator<(const String& str) const { return (str > *this); };
-  bool operator>(const String& str) const;
-  bool operator<=(const String& str) const { return !(*this > str); }
-  bool operator>=(const String& str) const { return !(*this < str); }
-  String operator+(const String& str) const;
-  String& operator+=(const String& str);
-  String operator*(int num) const;
-  String& operator*=(int num);
-  std::vector<String> Split(const String& delim = " ");
-  String Join(const std::vector<String>& strings);
+  operator StringView() const { return StringView(str_, size_); };
+  bool operator==(const BasicString& str) const {
+    return StringView(*this) == StringView(str);
+  };
+  bool operator!=(const BasicString& str) const { return !(str == *(this)); }
+  bool operator<(const BasicString& str) const { return (str > *this); };
+  bool operator>(const BasicString& str) const {
+    return StringView(*this) > StringView(str);
+  };
+  bool operator<=(const BasicString& str) const { return !(*this > str); }
+  bool operator>=(const BasicString& str) const { return !(*this < str); }
+  BasicString operator+(const BasicString& str) const&;
+  BasicString operator+(const BasicString& str) &&;
+  BasicString operator+(BasicString&& str) const&;
+  BasicString operator+(BasicString&& str) &&;
+  BasicString& operator+=(const BasicString& str);
+  BasicString& operator+=(BasicString&& str);
+  BasicString operator*(int num) const;
+  BasicString& operator*=(int num);
+  size_t Find(StringView needle, size_t pos = 0) const {
+    return Searcher(needle).Find(*this, pos);
+  };
+  size_t RFind(StringView needle, size_t pos = kNpos) const {
+    return Searcher(needle).RFind(*this, pos);
+  };
+  bool Contains(StringView needle) const { return Find(needle) != kNpos; };
+  bool StartsWith(StringView prefix) const;
+  bool EndsWith(StringView suffix) const;
+  size_t Count(StringView needle) const {
+    return Searcher(needle).Count(*this);
+  };
+  std::vector<BasicString> Split(StringView delim = " ");
+  // Same result as Split, with the scan and (for allocators that can be
+  // shared between threads) the copies spread over threads; 0 means one
+  // per hardware thread.
+  std::vector<BasicString> ParallelSplit(StringView delim = " ",
+                                         size_t threads = 0) const;
+  SplitRange SplitView(StringView delim = " ") const {
+    return SplitRange(*this, delim);
+  };
+  BasicString Join(const std::vector<BasicString>& strings) const {
+    return Join(strings.begin(), strings.end());
+  };
+  // Joins a forward range of anything convertible to StringView, sizing the
+  // result exactly up front so it is written with a single allocation.
+  template <typename Iterator>
+  BasicString Join(Iterator begin, Iterator end) const;
 
  private:
-  void Check(std::vector<String>& result) const;
-  void RealizeMemory(size_t size);
+  template <typename>
+  friend class BasicStringBuilder;
+  using alloc_traits = std::allocator_traits<Alloc>;
+  void RealizeMemory(size_t size, size_t old_capacity);
   void CheckCapacity();
-  void Spliting(std::vector<String>& result, int label_curr, int label);
+  void Allocate();
+  void TakeBuffer(BasicString& str);
+  void Release(size_t capacity) {
+    if (!IsInline()) {
+      alloc_traits::deallocate(alloc_, str_, capacity);
+    }
+  };
+  bool IsInline() const { return str_ == inline_; };
+  // Strings up to kInlineCapacity chars live in inline_ and never touch the
+  // allocator; str_ always points at whichever buffer is in use.
+  static constexpr size_t kInlineCapacity = 15;
+  [[no_unique_address]] Alloc alloc_;
   size_t size_ = 0;
-  size_t capacity_ = 1;
-  char* str_ = nullptr;
+  size_t capacity_ = kInlineCapacity;
+  char* str_ = inline_;
+  char inline_[kInlineCapacity + 1];
 };
 
-std::ostream& operator<<(std::ostream& os, const String& str);
-std::istream& operator>>(std::istream& is, String& str);
+using String = BasicString<>;
+
+template <typename Alloc>
+BasicString<Alloc>::BasicString(const char* str, const Alloc& alloc)
+    : alloc_(alloc), size_(strlen(str)) {
+  if (size_ > capacity_) {
+    capacity_ = size_ + 1;
+  }
+  Allocate();
+  std::copy(str, str + size_, str_);
+  if (size_ < capacity_) {
+    str_[size_] = '\0';
+  }
+}
+template <typename Alloc>
+BasicString<Alloc>::BasicString(StringView str, const Alloc& alloc)
+    : alloc_(alloc), size_(str.Size()) {
+  CheckCapacity();
+  Allocate();
+  std::copy(str.begin(), str.end(), str_);
+}
+template <typename Alloc>
+BasicString<Alloc>::BasicString(const BasicString& str)
+    : alloc_(alloc_traits::select_on_container_copy_construction(str.alloc_)),
+      size_(str.size_) {
+  CheckCapacity();
+  Allocate();
+  std::copy(str.str_, str.str_ + str.size_, str_);
+}
+template <typename Alloc>
+BasicString<Alloc>& BasicString<Alloc>::operator=(const BasicString& str) {
+  if (this != &str) {
+    if (alloc_traits::propagate_on_container_copy_assignment::value &&
+        alloc_ != str.alloc_) {
+      Release(capacity_);
+      str_ = inline_;
+      capacity_ = kInlineCapacity;
+      alloc_ = str.alloc_;
+    }
+    if (capacity_ < str.size_) {
+      Release(capacity_);
+      capacity_ = str.capacity_;
+      Allocate();
+    }
+    size_ = str.size_;
+    std::copy(str.str_, str.str_ + str.size_, str_);
+  }
+  return *this;
+}
+template <typename Alloc>
+BasicString<Alloc>::BasicString(BasicString&& str) noexcept
+    : alloc_(std::move(str.alloc_)) {
+  TakeBuffer(str);
+}
+template <typename Alloc>
+BasicString<Alloc>& BasicString<Alloc>::operator=(BasicString&& str) noexcept(
+    std::allocator_traits<Alloc>::propagate_on_container_move_assignment::
+        value ||
+    std::allocator_traits<Alloc>::is_always_equal::value) {
+  if (this != &str) {
+    if (alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_ == str.alloc_) {
+      Release(capacity_);
+      if (alloc_traits::propagate_on_container_move_assignment::value) {
+        alloc_ = std::move(str.alloc_);
+      }
+      TakeBuffer(str);
+    } else {
+      *this = static_cast<const BasicString&>(str);
+    }
+  }
+  return *this;
+}
+template <typename Alloc>
+BasicString<Alloc>& BasicString<Alloc>::operator=(const char* str) {
+  size_t capacity = capacity_;
+  size_ = strlen(str);
+  CheckCapacity();
+  if (capacity < capacity_) {
+    Release(capacity);
+    Allocate();
+  }
+  std::copy(str, str + size_, str_);
+  return *this;
+}
+template <typename Alloc>
+BasicString<Alloc>::BasicString(size_t size, char character,
+                                const Alloc& alloc)
+    : alloc_(alloc), size_(size) {
+  CheckCapacity();
+  Allocate();
+  for (size_t i = 0; i < size; ++i) {
+    str_[i] = character;
+  }
+}
+
+template <typename Alloc>
+void BasicString<Alloc>::CheckCapacity() {
+  // Doubling to the next power of two by default; building with
+  // STRING_GROWTH_FACTOR_1_5 grows by half the current capacity instead.
+  if (capacity_ < size_) {
+#ifdef STRING_GROWTH_FACTOR_1_5
+    capacity_ = std::max(size_, capacity_ + capacity_ / 2);
+#else
+    capacity_ = BitCeil(size_);
+#endif
+  }
+}
+template <typename Alloc>
+void BasicString<Alloc>::Allocate() {
+  str_ = (capacity_ > kInlineCapacity)
+             ? alloc_traits::allocate(alloc_, capacity_)
+             : inline_;
+}
+template <typename Alloc>
+void BasicString<Alloc>::TakeBuffer(BasicString& str) {
+  size_ = str.size_;
+  capacity_ = str.capacity_;
+  if (str.IsInline()) {
+    str_ = inline_;
+    std::copy(str.inline_, str.inline_ + str.size_, inline_);
+  } else {
+    str_ = str.str_;
+  }
+  str.str_ = str.inline_;
+  str.size_ = 0;
+  str.capacity_ = kInlineCapacity;
+}
+// Moves the first size chars into a buffer of the (already updated)
+// capacity_; old_capacity is what the current buffer was allocated with.
+template <typename Alloc>
+void BasicString<Alloc>::RealizeMemory(size_t size, size_t old_capacity) {
+  if constexpr (SupportsExpand<Alloc>::value) {
+    if (!IsInline() && capacity_ > old_capacity &&
+        alloc_.expand(str_, old_capacity, capacity_)) {
+      return;
+    }
+  }
+  char* old = str_;
+  bool was_inline = IsInline();
+  Allocate();
+  if (str_ != old) {
+    std::copy(old, old + size, str_);
+    if (!was_inline) {
+      alloc_traits::deallocate(alloc_, old, old_capacity);
+    }
+  }
+}
+template <typename Alloc>
+void BasicString<Alloc>::PushBack(char character) {
+  ++size_;
+  size_t capacity = capacity_;
+  CheckCapacity();
+  if (capacity != capacity_) {
+    RealizeMemory(size_ - 1, capacity);
+  }
+  str_[size_ - 1] = character;
+}
+template <typename Alloc>
+void BasicString<Alloc>::PopBack() {
+  if (size_ != 0) {
+    --size_;
+  }
+}
+template <typename Alloc>
+void BasicString<Alloc>::Resize(size_t new_size) {
+  if (new_size < size_) {
+    for (size_t i = new_size; i < size_; ++i) {
+      str_[i] = '\0';
+    }
+  }
+  size_t size = size_;
+  size_ = new_size;
+  size_t capacity = capacity_;
+  CheckCapacity();
+  if (capacity != capacity_) {
+    RealizeMemory(size, capacity);
+  }
+}
+template <typename Alloc>
+void BasicString<Alloc>::Resize(size_t new_size, char character) {
+  if (new_size < size_) {
+    for (size_t i = new_size; i < size_; ++i) {
+      str_[i] = '\0';
+    }
+  }
+  size_t size = size_;
+  Resize(new_size);
+  if (size_ > size) {
+    for (size_t i = size; i < size_; ++i) {
+      str_[i] = character;
+    }
+  }
+}
+template <typename Alloc>
+void BasicString<Alloc>::Reserve(size_t new_cap) {
+  if (new_cap > capacity_) {
+    size_t capacity = capacity_;
+    capacity_ = new_cap;
+    RealizeMemory(size_, capacity);
+  }
+}
+template <typename Alloc>
+void BasicString<Alloc>::ShrinkToFit() {
+  if (capacity_ > size_ && !IsInline()) {
+    size_t capacity = capacity_;
+    capacity_ = std::max(size_, kInlineCapacity);
+    RealizeMemory(size_, capacity);
+  }
+}
+template <typename Alloc>
+void BasicString<Alloc>::Swap(BasicString& other) {
+  if (alloc_traits::propagate_on_container_swap::value) {
+    std::swap(alloc_, other.alloc_);
+  }
+  char* str = other.IsInline() ? inline_ : other.str_;
+  char* other_str = IsInline() ? other.inline_ : str_;
+  std::swap(inline_, other.inline_);
+  str_ = str;
+  other.str_ = other_str;
+  std::swap(other.size_, size_);
+  std::swap(other.capacity_, capacity_);
+}
+template <typename Alloc>
+BasicString<Alloc>& BasicString<Alloc>::operator+=(const BasicString& str) {
+  size_t size = size_;
+  size_t add = str.size_;
+  size_ += add;
+  size_t capacity = capacity_;
+  CheckCapacity();
+  if (capacity != capacity_) {
+    RealizeMemory(size, capacity);
+  }
+  std::copy(str.str_, str.str_ + add, str_ + size);
+  return (*this);
+}
+template <typename Alloc>
+BasicString<Alloc>& BasicString<Alloc>::operator+=(BasicString&& str) {
+  if (size_ == 0 && !str.IsInline() && this != &str && alloc_ == str.alloc_) {
+    return *this = std::move(str);
+  }
+  return *this += static_cast<const BasicString&>(str);
+}
+template <typename Alloc>
+BasicString<Alloc> BasicString<Alloc>::operator+(
+    const BasicString& str) const& {
+  BasicString new_str(
+      alloc_traits::select_on_container_copy_construction(alloc_));
+  new_str.Reserve(size_ + str.size_);
+  new_str += *this;
+  new_str += str;
+  return new_str;
+}
+template <typename Alloc>
+BasicString<Alloc> BasicString<Alloc>::operator+(const BasicString& str) && {
+  *this += str;
+  return std::move(*this);
+}
+template <typename Alloc>
+BasicString<Alloc> BasicString<Alloc>::operator+(BasicString&& str) const& {
+  if (this == &str || str.capacity_ < size_ + str.size_) {
+    return *this + static_cast<const BasicString&>(str);
+  }
+  std::copy_backward(str.str_, str.str_ + str.size_,
+                     str.str_ + size_ + str.size_);
+  std::copy(str_, str_ + size_, str.str_);
+  str.size_ += size_;
+  return std::move(str);
+}
+template <typename Alloc>
+BasicString<Alloc> BasicString<Alloc>::operator+(BasicString&& str) && {
+  *this += str;
+  return std::move(*this);
+}
+template <typename Alloc>
+BasicString<Alloc> BasicString<Alloc>::operator*(int num) const {
+  BasicString new_string = *this;
+  new_string *= num;
+  return new_string;
+}
+template <typename Alloc>
+BasicString<Alloc>& BasicString<Alloc>::operator*=(int num) {
+  int size = static_cast<int>(size_);
+  size_ *= num;
+  size_t capacity = capacity_;
+  CheckCapacity();
+  if (capacity != capacity_) {
+    RealizeMemory(size, capacity);
+  }
+  for (int i = size; i < static_cast<int>(size_); i += size) {
+    std::copy(str_, str_ + size, str_ + i);
+  }
+  return *this;
+}
+template <typename Alloc>
+template <typename Iterator>
+BasicString<Alloc> BasicString<Alloc>::Join(Iterator begin,
+                                            Iterator end) const {
+  BasicString new_string(
+      alloc_traits::select_on_container_copy_construction(alloc_));
+  if (begin == end) {
+    return new_string;
+  }
+  size_t size = 0;
+  size_t count = 0;
+  for (Iterator it = begin; it != end; ++it) {
+    size += StringView(*it).Size();
+    ++count;
+  }
+  size += size_ * (count - 1);
+  new_string.capacity_ = std::max(size, kInlineCapacity);
+  new_string.Allocate();
+  char* curr = new_string.str_;
+  for (Iterator it = begin; it != end; ++it) {
+    if (it != begin) {
+      curr = std::copy(str_, str_ + size_, curr);
+    }
+    StringView piece(*it);
+    curr = std::copy(piece.begin(), piece.end(), curr);
+  }
+  new_string.size_ = size;
+  return new_string;
+}
+template <typename Alloc>
+bool BasicString<Alloc>::StartsWith(StringView prefix) const {
+  return prefix.Size() <= size_ &&
+         memcmp(str_, prefix.Data(), prefix.Size()) == 0;
+}
+template <typename Alloc>
+bool BasicString<Alloc>::EndsWith(StringView suffix) const {
+  return suffix.Size() <= size_ &&
+         memcmp(str_ + size_ - suffix.Size(), suffix.Data(), suffix.Size()) ==
+             0;
+}
+template <typename Alloc>
+std::vector<BasicString<Alloc>> BasicString<Alloc>::Split(StringView delim) {
+  std::vector<BasicString> result;
+  for (StringView field : SplitView(delim)) {
+    result.emplace_back(field, alloc_);
+  }
+  return result;
+}
+
+template <typename Alloc>
+std::vector<BasicString<Alloc>> BasicString<Alloc>::ParallelSplit(
+    StringView delim, size_t threads) const {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<StringView> fields = SplitFields(*this, delim, threads);
+  if (!alloc_traits::is_always_equal::value) {
+    // A stateful allocator (e.g. an Arena) is not safe to share.
+    threads = 1;
+  }
+  threads = std::min(threads, size_ / kParallelSplitChunk + 1);
+  std::vector<std::vector<BasicString>> parts(threads);
+  auto build = [&](size_t part) {
+    size_t begin = fields.size() * part / threads;
+    size_t end = fields.size() * (part + 1) / threads;
+    parts[part].reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+      parts[part].emplace_back(fields[i], alloc_);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t part = 1; part < threads; ++part) {
+    workers.emplace_back(build, part);
+  }
+  build(0);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  std::vector<BasicString> result = std::move(parts[0]);
+  result.reserve(fields.size());
+  for (size_t part = 1; part < threads; ++part) {
+    std::move(parts[part].begin(), parts[part].end(),
+              std::back_inserter(result));
+  }
+  return result;
+}
+
+namespace std {
+template <typename Alloc>
+struct hash<BasicString<Alloc>> {
+  size_t operator()(const BasicString<Alloc>& str) const {
+    return hash<StringView>()(str);
+  }
+};
+}  // namespace std
+
+template <typename Alloc>
+std::ostream& operator<<(std::ostream& os, const BasicString<Alloc>& str) {
+  return os << StringView(str);
+}
+// Exposes the protected get-area pointers of any std::streambuf, so the
+// extraction functions below can scan the buffered bytes in place and
+// consume whole runs at once instead of calling get() per character.
+struct StreamBufferAccess : std::streambuf {
+  static const char* Begin(std::streambuf* buf) {
+    return (buf->*&StreamBufferAccess::gptr)();
+  }
+  static const char* End(std::streambuf* buf) {
+    return (buf->*&StreamBufferAccess::egptr)();
+  }
+  static void Consume(std::streambuf* buf, size_t count) {
+    (buf->*&StreamBufferAccess::gbump)(static_cast<int>(count));
+  }
+};
+
+inline bool IsSpace(char character) {
+  return character == ' ' || (character >= '\t' && character <= '\r');
+}
+
+template <typename Alloc>
+void AppendRun(BasicString<Alloc>& str, const char* begin, const char* end) {
+  size_t size = str.Size();
+  str.Resize(size + (end - begin));
+  std::copy(begin, end, str.Data() + size);
+}
+
+// Reads the next whitespace-delimited word and appends it to str.
+template <typename Alloc>
+std::istream& operator>>(std::istream& is, BasicString<Alloc>& str) {
+  std::istream::sentry sentry(is);
+  if (!sentry) {
+    return is;
+  }
+  std::streambuf* buf = is.rdbuf();
+  bool extracted = false;
+  while (true) {
+    const char* begin = StreamBufferAccess::Begin(buf);
+    const char* end = StreamBufferAccess::End(buf);
+    if (begin == end) {
+      int next = buf->sgetc();
+      if (next == std::char_traits<char>::eof()) {
+        is.setstate(std::ios_base::eofbit);
+        break;
+      }
+      if (StreamBufferAccess::Begin(buf) == StreamBufferAccess::End(buf)) {
+        // Unbuffered stream: fall back to one character at a time.
+        if (IsSpace(static_cast<char>(next))) {
+          break;
+        }
+        str.PushBack(static_cast<char>(next));
+        buf->sbumpc();
+        extracted = true;
+      }
+      continue;
+    }
+    const char* stop = std::find_if(begin, end, IsSpace);
+    AppendRun(str, begin, stop);
+    StreamBufferAccess::Consume(buf, stop - begin);
+    extracted = extracted || stop != begin;
+    if (stop != end) {
+      break;
+    }
+  }
+  if (!extracted) {
+    is.setstate(std::ios_base::failbit);
+  }
+  return is;
+}
+
+// Replaces str with the next line (without the delimiter, which is
+// consumed), scanning the stream buffer like operator>>.
+template <typename Alloc>
+std::istream& GetLine(std::istream& is, BasicString<Alloc>& str,
+                      char delim = '\n') {
+  str.Clear();
+  std::istream::sentry sentry(is, true);
+  if (!sentry) {
+    return is;
+  }
+  std::streambuf* buf = is.rdbuf();
+  bool extracted = false;
+  while (true) {
+    const char* begin = StreamBufferAccess::Begin(buf);
+    const char* end = StreamBufferAccess::End(buf);
+    if (begin == end) {
+      int next = buf->sgetc();
+      if (next == std::char_traits<char>::eof()) {
+        is.setstate(std::ios_base::eofbit);
+        break;
+      }
+      if (StreamBufferAccess::Begin(buf) == StreamBufferAccess::End(buf)) {
+        buf->sbumpc();
+        extracted = true;
+        if (static_cast<char>(next) == delim) {
+          break;
+        }
+        str.PushBack(static_cast<char>(next));
+      }
+      continue;
+    }
+    const char* stop =
+        static_cast<const char*>(memchr(begin, delim, end - begin));
+    AppendRun(str, begin, stop == nullptr ? end : stop);
+    extracted = true;
+    if (stop != nullptr) {
+      StreamBufferAccess::Consume(buf, stop - begin + 1);
+      break;
+    }
+    StreamBufferAccess::Consume(buf, end - begin);
+  }
+  if (!extracted) {
+    is.setstate(std::ios_base::failbit);
+  }
+  return is;
+}
+
+extern template class BasicString<>;
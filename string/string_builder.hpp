@@ -0,0 +1,120 @@
+#pragma once
+#include <charconv>
+#include <iterator>
+#include <type_traits>
+
+#include "string.hpp"
+
+// Accumulates text into a single growing buffer and hands it over as a
+// String without a final copy. Numbers are formatted with std::to_chars
+// straight into the buffer, so no temporary Strings are created.
+template <typename Alloc = std::allocator<char>>
+class BasicStringBuilder {
+ public:
+  BasicStringBuilder() = default;
+  explicit BasicStringBuilder(const Alloc& alloc) : str_(alloc){};
+  size_t Size() const { return str_.Size(); };
+  StringView View() const { return str_; };
+  void Reserve(size_t new_cap) { str_.Reserve(new_cap); };
+  void Clear() { str_.Clear(); };
+  BasicStringBuilder& Append(StringView str);
+  BasicStringBuilder& Append(char character);
+  // For forward iterators the total size is computed first, so the whole
+  // range costs at most one reallocation.
+  template <typename Iterator>
+  BasicStringBuilder& AppendRange(Iterator begin, Iterator end,
+                                  StringView delim = "");
+  // Integers in decimal, floating point in the shortest form that reads
+  // back to the same value.
+  template <typename T>
+  BasicStringBuilder& AppendFormatted(T value);
+  template <typename T>
+  BasicStringBuilder& AppendFormatted(T value, std::chars_format format,
+                                      int precision);
+  BasicString<Alloc> Build() { return std::move(str_); };
+
+ private:
+  void Grow(size_t count);
+  template <typename... Args>
+  void WriteChars(size_t guess, Args... args);
+
+  BasicString<Alloc> str_;
+};
+
+using StringBuilder = BasicStringBuilder<>;
+
+template <typename Alloc>
+void BasicStringBuilder<Alloc>::Grow(size_t count) {
+  if (str_.size_ + count > str_.capacity_) {
+    str_.Reserve(std::max(str_.size_ + count, str_.capacity_ * 2));
+  }
+}
+template <typename Alloc>
+BasicStringBuilder<Alloc>& BasicStringBuilder<Alloc>::Append(StringView str) {
+  Grow(str.Size());
+  std::copy(str.begin(), str.end(), str_.str_ + str_.size_);
+  str_.size_ += str.Size();
+  return *this;
+}
+template <typename Alloc>
+BasicStringBuilder<Alloc>& BasicStringBuilder<Alloc>::Append(char character) {
+  Grow(1);
+  str_.str_[str_.size_++] = character;
+  return *this;
+}
+template <typename Alloc>
+template <typename Iterator>
+BasicStringBuilder<Alloc>& BasicStringBuilder<Alloc>::AppendRange(
+    Iterator begin, Iterator end, StringView delim) {
+  using Category = typename std::iterator_traits<Iterator>::iterator_category;
+  if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+    size_t size = 0;
+    for (Iterator it = begin; it != end; ++it) {
+      if (it != begin) {
+        size += delim.Size();
+      }
+      size += StringView(*it).Size();
+    }
+    Grow(size);
+  }
+  for (Iterator it = begin; it != end; ++it) {
+    if (it != begin) {
+      Append(delim);
+    }
+    Append(StringView(*it));
+  }
+  return *this;
+}
+template <typename Alloc>
+template <typename... Args>
+void BasicStringBuilder<Alloc>::WriteChars(size_t guess, Args... args) {
+  while (true) {
+    Grow(guess);
+    auto [end, error] = std::to_chars(str_.str_ + str_.size_,
+                                      str_.str_ + str_.capacity_, args...);
+    if (error == std::errc()) {
+      str_.size_ = end - str_.str_;
+      return;
+    }
+    guess *= 2;
+  }
+}
+template <typename Alloc>
+template <typename T>
+BasicStringBuilder<Alloc>& BasicStringBuilder<Alloc>::AppendFormatted(
+    T value) {
+  static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                "AppendFormatted expects an integer or floating point value");
+  WriteChars(std::is_integral_v<T> ? 24 : 32, value);
+  return *this;
+}
+template <typename Alloc>
+template <typename T>
+BasicStringBuilder<Alloc>& BasicStringBuilder<Alloc>::AppendFormatted(
+    T value, std::chars_format format, int precision) {
+  static_assert(std::is_floating_point_v<T>,
+                "precision only applies to floating point values");
+  WriteChars(static_cast<size_t>(std::max(precision, 0)) + 32, value, format,
+             precision);
+  return *this;
+}
@@ -0,0 +1,87 @@
+#include "string_hash.hpp"
+
+#include <cstring>
+
+namespace {
+const uint64_t kSecret[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+                             0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+void Multiply(uint64_t& lhs, uint64_t& rhs) {
+#ifdef __SIZEOF_INT128__
+  __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+  lhs = static_cast<uint64_t>(product);
+  rhs = static_cast<uint64_t>(product >> 64);
+#else
+  uint64_t lhs_hi = lhs >> 32;
+  uint64_t lhs_lo = static_cast<uint32_t>(lhs);
+  uint64_t rhs_hi = rhs >> 32;
+  uint64_t rhs_lo = static_cast<uint32_t>(rhs);
+  uint64_t hi_hi = lhs_hi * rhs_hi;
+  uint64_t hi_lo = lhs_hi * rhs_lo;
+  uint64_t lo_hi = lhs_lo * rhs_hi;
+  uint64_t lo_lo = lhs_lo * rhs_lo;
+  uint64_t middle = hi_lo + (lo_lo >> 32) + static_cast<uint32_t>(lo_hi);
+  lhs = (middle << 32) | static_cast<uint32_t>(lo_lo);
+  rhs = hi_hi + (middle >> 32) + (lo_hi >> 32);
+#endif
+}
+uint64_t Mix(uint64_t lhs, uint64_t rhs) {
+  Multiply(lhs, rhs);
+  return lhs ^ rhs;
+}
+uint64_t Read8(const unsigned char* ptr) {
+  uint64_t value;
+  memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+uint64_t Read4(const unsigned char* ptr) {
+  uint32_t value;
+  memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+uint64_t Read3(const unsigned char* ptr, size_t size) {
+  return (static_cast<uint64_t>(ptr[0]) << 16) |
+         (static_cast<uint64_t>(ptr[size >> 1]) << 8) | ptr[size - 1];
+}
+}  // namespace
+
+uint64_t HashBytes(const char* data, size_t size, uint64_t seed) {
+  const unsigned char* ptr = reinterpret_cast<const unsigned char*>(data);
+  seed ^= Mix(seed ^ kSecret[0], kSecret[1]);
+  uint64_t lhs = 0;
+  uint64_t rhs = 0;
+  if (size <= 16) {
+    if (size >= 4) {
+      size_t shift = (size >> 3) << 2;
+      lhs = (Read4(ptr) << 32) | Read4(ptr + shift);
+      rhs = (Read4(ptr + size - 4) << 32) | Read4(ptr + size - 4 - shift);
+    } else if (size > 0) {
+      lhs = Read3(ptr, size);
+    }
+  } else {
+    size_t left = size;
+    if (left >= 48) {
+      uint64_t seed1 = seed;
+      uint64_t seed2 = seed;
+      do {
+        seed = Mix(Read8(ptr) ^ kSecret[1], Read8(ptr + 8) ^ seed);
+        seed1 = Mix(Read8(ptr + 16) ^ kSecret[2], Read8(ptr + 24) ^ seed1);
+        seed2 = Mix(Read8(ptr + 32) ^ kSecret[3], Read8(ptr + 40) ^ seed2);
+        ptr += 48;
+        left -= 48;
+      } while (left >= 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (left > 16) {
+      seed = Mix(Read8(ptr) ^ kSecret[1], Read8(ptr + 8) ^ seed);
+      ptr += 16;
+      left -= 16;
+    }
+    lhs = Read8(ptr + left - 16);
+    rhs = Read8(ptr + left - 8);
+  }
+  lhs ^= kSecret[1];
+  rhs ^= seed;
+  Multiply(lhs, rhs);
+  return Mix(lhs ^ kSecret[0] ^ size, rhs ^ kSecret[1]);
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Fast non-cryptographic hash of a byte range (wyhash construction: 48-byte
+// stripes folded through 64x64->128 multiplies). Values are only stable
+// within one build and must not be persisted.
+uint64_t HashBytes(const char* data, size_t size, uint64_t seed = 0);
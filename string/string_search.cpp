@@ -0,0 +1,327 @@
+#include "string_search.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STRING_SEARCH_X86 1
+#endif
+
+namespace {
+using FindCharFn = const char* (*)(const char*, const char*, char);
+using FindPairFn = const char* (*)(const char*, const char*, const char*,
+                                   size_t);
+
+const char* FindCharScalar(const char* begin, const char* end,
+                           char character) {
+  const void* found = memchr(begin, character, end - begin);
+  return found == nullptr ? end : static_cast<const char*>(found);
+}
+const char* FindPairScalar(const char* begin, const char* end,
+                           const char* needle, size_t size) {
+  const char* last = end - size;
+  while (begin <= last) {
+    begin = FindCharScalar(begin, last + 1, needle[0]);
+    if (begin > last) {
+      break;
+    }
+    if (memcmp(begin + 1, needle + 1, size - 1) == 0) {
+      return begin;
+    }
+    ++begin;
+  }
+  return end;
+}
+
+#ifdef STRING_SEARCH_X86
+__attribute__((target("sse2"))) const char* FindCharSse2(const char* begin,
+                                                          const char* end,
+                                                          char character) {
+  __m128i pattern = _mm_set1_epi8(character);
+  for (; end - begin >= 16; begin += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  for (; begin < end; ++begin) {
+    if (*begin == character) {
+      return begin;
+    }
+  }
+  return end;
+}
+__attribute__((target("avx2"))) const char* FindCharAvx2(const char* begin,
+                                                          const char* end,
+                                                          char character) {
+  __m256i pattern = _mm256_set1_epi8(character);
+  for (; end - begin >= 32; begin += 32) {
+    __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    unsigned mask = static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern)));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return FindCharSse2(begin, end, character);
+}
+
+// Both kernels compare a block of candidate starts against the needle's
+// first byte and the block size - 1 bytes further against its last byte;
+// only positions where both match are checked in full.
+__attribute__((target("sse2"))) const char* FindPairSse2(const char* begin,
+                                                          const char* end,
+                                                          const char* needle,
+                                                          size_t size) {
+  __m128i first = _mm_set1_epi8(needle[0]);
+  __m128i last = _mm_set1_epi8(needle[size - 1]);
+  for (; static_cast<size_t>(end - begin) >= size + 15; begin += 16) {
+    __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    __m128i block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + size - 1));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+    while (mask != 0) {
+      int bit = __builtin_ctz(mask);
+      if (memcmp(begin + bit + 1, needle + 1, size - 2) == 0) {
+        return begin + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return FindPairScalar(begin, end, needle, size);
+}
+__attribute__((target("avx2"))) const char* FindPairAvx2(const char* begin,
+                                                          const char* end,
+                                                          const char* needle,
+                                                          size_t size) {
+  __m256i first = _mm256_set1_epi8(needle[0]);
+  __m256i last = _mm256_set1_epi8(needle[size - 1]);
+  for (; static_cast<size_t>(end - begin) >= size + 31; begin += 32) {
+    __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    __m256i block_last = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(begin + size - 1));
+    unsigned mask = static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(block_first, first),
+            _mm256_cmpeq_epi8(block_last, last))));
+    while (mask != 0) {
+      int bit = __builtin_ctz(mask);
+      if (memcmp(begin + bit + 1, needle + 1, size - 2) == 0) {
+        return begin + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return FindPairSse2(begin, end, needle, size);
+}
+#endif
+
+struct Kernels {
+  FindCharFn find_char;
+  FindPairFn find_pair;
+};
+
+Kernels SelectKernels() {
+#ifdef STRING_SEARCH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {FindCharAvx2, FindPairAvx2};
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return {FindCharSse2, FindPairSse2};
+  }
+#endif
+  return {FindCharScalar, FindPairScalar};
+}
+
+const Kernels& GetKernels() {
+  static const Kernels kKernels = SelectKernels();
+  return kKernels;
+}
+
+const char* FindShort(const char* begin, const char* end, StringView needle) {
+  if (needle.Size() == 1) {
+    return GetKernels().find_char(begin, end, needle[0]);
+  }
+  return GetKernels().find_pair(begin, end, needle.Data(), needle.Size());
+}
+
+template <bool Reversed>
+unsigned char At(StringView str, size_t ind) {
+  return static_cast<unsigned char>(Reversed ? str[str.Size() - 1 - ind]
+                                             : str[ind]);
+}
+}  // namespace
+
+size_t SearchChar(StringView str, size_t from, char character) {
+  if (from >= str.Size()) {
+    return StringView::kNpos;
+  }
+  const char* found =
+      GetKernels().find_char(str.begin() + from, str.end(), character);
+  return found == str.end() ? StringView::kNpos : found - str.begin();
+}
+
+size_t SearchSubstring(StringView str, size_t from, StringView needle) {
+  if (needle.Empty()) {
+    return StringView::kNpos;
+  }
+  return Searcher(needle).Find(str, from);
+}
+
+Searcher::Searcher(StringView needle) : needle_(needle) {
+  if (needle_.Size() > kShortNeedle) {
+    forward_ = Factorize<false>(needle_);
+    backward_ = Factorize<true>(needle_);
+  }
+}
+
+template <bool Reversed>
+Searcher::Factorization Searcher::Factorize(StringView needle) {
+  // Critical factorization from the larger of the two maximal suffixes
+  // (one per alphabet order); indices start at SIZE_MAX and rely on
+  // unsigned wrap-around, as in the original formulation.
+  size_t size = needle.Size();
+  size_t max_suffix[2];
+  size_t period[2];
+  for (int order = 0; order < 2; ++order) {
+    size_t suffix = static_cast<size_t>(-1);
+    size_t ind = 0;
+    size_t shift = 1;
+    size_t per = 1;
+    while (ind + shift < size) {
+      unsigned char lhs = At<Reversed>(needle, ind + shift);
+      unsigned char rhs = At<Reversed>(needle, suffix + shift);
+      if (order == 1) {
+        std::swap(lhs, rhs);
+      }
+      if (lhs < rhs) {
+        ind += shift;
+        shift = 1;
+        per = ind - suffix;
+      } else if (lhs == rhs) {
+        if (shift != per) {
+          ++shift;
+        } else {
+          ind += per;
+          shift = 1;
+        }
+      } else {
+        suffix = ind++;
+        shift = per = 1;
+      }
+    }
+    max_suffix[order] = suffix + 1;
+    period[order] = per;
+  }
+  int best = (max_suffix[1] > max_suffix[0]) ? 1 : 0;
+  Factorization fact;
+  fact.suffix = max_suffix[best];
+  fact.period = period[best];
+  fact.periodic = true;
+  for (size_t i = 0; i < fact.suffix; ++i) {
+    if (At<Reversed>(needle, i) != At<Reversed>(needle, i + fact.period)) {
+      fact.periodic = false;
+      break;
+    }
+  }
+  if (!fact.periodic) {
+    fact.period = std::max(fact.suffix, size - fact.suffix) + 1;
+  }
+  return fact;
+}
+
+template <bool Reversed>
+size_t Searcher::TwoWay(StringView str, const Factorization& fact) const {
+  // With Reversed both str and needle_ are read back to front and the
+  // result is an offset from the end of str.
+  size_t size = needle_.Size();
+  size_t suffix = fact.suffix;
+  size_t memory = 0;
+  for (size_t pos = 0; pos + size <= str.Size();) {
+    size_t ind = fact.periodic ? std::max(suffix, memory) : suffix;
+    while (ind < size &&
+           At<Reversed>(needle_, ind) == At<Reversed>(str, ind + pos)) {
+      ++ind;
+    }
+    if (ind < size) {
+      pos += ind - suffix + 1;
+      memory = 0;
+      continue;
+    }
+    size_t low = fact.periodic ? memory : 0;
+    ind = suffix;
+    while (ind > low &&
+           At<Reversed>(needle_, ind - 1) == At<Reversed>(str, ind - 1 + pos)) {
+      --ind;
+    }
+    if (ind <= low) {
+      return pos;
+    }
+    pos += fact.period;
+    if (fact.periodic) {
+      memory = size - fact.period;
+    }
+  }
+  return StringView::kNpos;
+}
+
+size_t Searcher::Find(StringView str, size_t from) const {
+  if (from > str.Size() || needle_.Size() > str.Size() - from) {
+    return StringView::kNpos;
+  }
+  if (needle_.Empty()) {
+    return from;
+  }
+  if (needle_.Size() <= kShortNeedle) {
+    const char* found = FindShort(str.begin() + from, str.end(), needle_);
+    return found == str.end() ? StringView::kNpos : found - str.begin();
+  }
+  size_t found = TwoWay<false>(str.Substr(from, StringView::kNpos), forward_);
+  return found == StringView::kNpos ? found : found + from;
+}
+
+size_t Searcher::RFind(StringView str, size_t pos) const {
+  if (needle_.Size() > str.Size()) {
+    return StringView::kNpos;
+  }
+  size_t last = std::min(pos, str.Size() - needle_.Size());
+  StringView window = str.Substr(0, last + needle_.Size());
+  if (needle_.Empty()) {
+    return last;
+  }
+  if (needle_.Size() == 1) {
+    for (size_t ind = window.Size(); ind > 0; --ind) {
+      if (window[ind - 1] == needle_[0]) {
+        return ind - 1;
+      }
+    }
+    return StringView::kNpos;
+  }
+  const Factorization& fact = (needle_.Size() > kShortNeedle)
+                                  ? backward_
+                                  : Factorize<true>(needle_);
+  size_t found = TwoWay<true>(window, fact);
+  return found == StringView::kNpos
+             ? found
+             : window.Size() - found - needle_.Size();
+}
+
+size_t Searcher::Count(StringView str) const {
+  if (needle_.Empty()) {
+    return str.Size() + 1;
+  }
+  size_t count = 0;
+  for (size_t pos = Find(str); pos != StringView::kNpos;
+       pos = Find(str, pos + needle_.Size())) {
+    ++count;
+  }
+  return count;
+}
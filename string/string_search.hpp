@@ -0,0 +1,42 @@
+#pragma once
+#include "string_view.hpp"
+
+// Position of the first occurrence of character / needle in str at or after
+// from, or StringView::kNpos if there is none. On x86 short needles are
+// scanned with SSE2, or AVX2 when the CPU supports it; the kernel is picked
+// once at runtime. Multi-byte needles are filtered on their first and last
+// bytes and each candidate is verified with memcmp. Longer needles go
+// through Searcher, so the worst case stays linear. Unlike Searcher::Find,
+// an empty needle never matches: these back the delimiter scans, where an
+// empty delimiter means the input is not split.
+size_t SearchChar(StringView str, size_t from, char character);
+size_t SearchSubstring(StringView str, size_t from, StringView needle);
+
+// Needle preprocessed once for the Two-Way (Crochemore-Perrin) algorithm:
+// O(n + m) worst case and O(1) extra space per search. Reuse one Searcher to
+// scan many haystacks for the same needle. The needle must outlive it.
+class Searcher {
+ public:
+  explicit Searcher(StringView needle);
+  size_t Find(StringView str, size_t from = 0) const;
+  size_t RFind(StringView str, size_t pos = StringView::kNpos) const;
+  // Number of non-overlapping occurrences.
+  size_t Count(StringView str) const;
+
+ private:
+  struct Factorization {
+    size_t suffix = 0;
+    size_t period = 1;
+    bool periodic = false;
+  };
+  template <bool Reversed>
+  static Factorization Factorize(StringView needle);
+  template <bool Reversed>
+  size_t TwoWay(StringView str, const Factorization& fact) const;
+
+  // Needles up to this length use the SIMD filter instead of Two-Way.
+  static constexpr size_t kShortNeedle = 32;
+  StringView needle_;
+  Factorization forward_;
+  Factorization backward_;
+};
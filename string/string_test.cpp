@@ -0,0 +1,73 @@
+// Regression checks for String and its helpers. Build from this directory
+// with every library source:
+//   g++ -std=c++20 -O1 -fsanitize=address,undefined string_test.cpp
+//       arena.cpp rope.cpp shared_string.cpp string.cpp string_hash.cpp
+//       string_search.cpp string_view.cpp -o string_test
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+#include "rope.hpp"
+#include "string.hpp"
+#include "string_search.hpp"
+
+namespace {
+
+void TestEmptyDelimiterDoesNotSplit() {
+  String str("abc");
+  std::vector<String> fields = str.Split("");
+  assert(fields.size() == 1 && StringView(fields[0]) == "abc");
+  size_t count = 0;
+  for (StringView field : str.SplitView("")) {
+    assert(field == "abc");
+    ++count;
+  }
+  assert(count == 1);
+  fields = str.ParallelSplit("", 4);
+  assert(fields.size() == 1 && StringView(fields[0]) == "abc");
+  assert(SearchSubstring("abc", 0, "") == StringView::kNpos);
+  assert(Searcher("").Find("abc", 1) == 1);
+}
+
+// Both sides of r += r share every node, which used to degrade the tree
+// into a chain and overflow the stack long before 2^21 pieces.
+void TestRopeSelfConcatenationStaysBalanced() {
+  const StringView kPiece = "rope!";
+  Rope rope{String(kPiece)};
+  const int kDoublings = 21;
+  for (int i = 0; i < kDoublings; ++i) {
+    if (i % 3 == 0) {
+      rope = rope + rope;
+    } else if (i % 3 == 1) {
+      rope += rope;
+    } else {
+      Rope copy = rope;
+      rope += copy.Substr(0);
+    }
+  }
+  size_t size = kPiece.Size() << kDoublings;
+  assert(rope.Size() == size);
+  String flat = rope.Flatten();
+  assert(flat.Size() == size);
+  for (size_t i = 0; i < size; i += 4099) {
+    assert(flat[i] == kPiece[i % kPiece.Size()]);
+    assert(rope[i] == kPiece[i % kPiece.Size()]);
+  }
+  size_t pos = size / 3 + 2;
+  Rope middle = rope.Substr(pos, 12);
+  assert(middle.Size() == 12);
+  String middle_flat = middle.Flatten();
+  for (size_t i = 0; i < 12; ++i) {
+    assert(middle_flat[i] == kPiece[(pos + i) % kPiece.Size()]);
+  }
+  Rope joined = rope.Substr(1) + rope.Substr(0, 1);
+  assert(joined.Size() == size && joined[size - 1] == kPiece[0]);
+}
+
+}  // namespace
+
+int main() {
+  TestEmptyDelimiterDoesNotSplit();
+  TestRopeSelfConcatenationStaysBalanced();
+  puts("OK");
+}
@@ -0,0 +1,159 @@
+#include "string_view.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include "string_search.hpp"
+
+namespace {
+bool SelfOverlaps(StringView delim) {
+  for (size_t len = 1; len < delim.Size(); ++len) {
+    if (memcmp(delim.Data(), delim.end() - len, len) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+// Every field of region, before empty fields are collapsed.
+void RawFields(StringView region, StringView delim,
+               std::vector<StringView>& fields) {
+  size_t label = 0;
+  while (true) {
+    size_t pos = SearchSubstring(region, label, delim);
+    if (pos == StringView::kNpos) {
+      fields.push_back(region.Substr(label, StringView::kNpos));
+      return;
+    }
+    fields.push_back(region.Substr(label, pos - label));
+    label = pos + delim.Size();
+  }
+}
+}  // namespace
+
+StringView StringView::Substr(size_t pos, size_t count) const {
+  pos = std::min(pos, size_);
+  return StringView(str_ + pos, std::min(count, size_ - pos));
+}
+void StringView::RemovePrefix(size_t count) {
+  str_ += count;
+  size_ -= count;
+}
+void StringView::RemoveSuffix(size_t count) { size_ -= count; }
+
+bool operator==(StringView lhs, StringView rhs) {
+  return lhs.Size() == rhs.Size() &&
+         memcmp(lhs.Data(), rhs.Data(), lhs.Size()) == 0;
+}
+bool operator!=(StringView lhs, StringView rhs) { return !(lhs == rhs); }
+bool operator<(StringView lhs, StringView rhs) { return rhs > lhs; }
+bool operator>(StringView lhs, StringView rhs) {
+  size_t min = std::min(lhs.Size(), rhs.Size());
+  int cmp = memcmp(lhs.Data(), rhs.Data(), min);
+  if (cmp != 0) {
+    return cmp > 0;
+  }
+  return lhs.Size() > rhs.Size();
+}
+bool operator<=(StringView lhs, StringView rhs) { return !(lhs > rhs); }
+bool operator>=(StringView lhs, StringView rhs) { return !(lhs < rhs); }
+std::ostream& operator<<(std::ostream& os, StringView str) {
+  return os.write(str.Data(), static_cast<std::streamsize>(str.Size()));
+}
+
+SplitRange::Iterator SplitRange::begin() const {
+  return Iterator(str_, delim_);
+}
+SplitRange::Iterator SplitRange::end() const { return Iterator(); }
+
+SplitRange::Iterator::Iterator(StringView str, StringView delim)
+    : str_(str), delim_(delim), done_(false) {
+  if (str_.Empty()) {
+    // Splitting an empty string yields exactly one empty field.
+    scanned_ = true;
+    emitted_ = 1;
+    field_ = str_;
+  } else {
+    Advance();
+  }
+}
+SplitRange::Iterator& SplitRange::Iterator::operator++() {
+  Advance();
+  return *this;
+}
+SplitRange::Iterator SplitRange::Iterator::operator++(int) {
+  Iterator old = *this;
+  Advance();
+  return old;
+}
+void SplitRange::Iterator::Advance() {
+  while (!scanned_) {
+    size_t pos = SearchSubstring(str_, label_, delim_);
+    StringView field = str_.Substr(label_, pos - label_);
+    if (pos == StringView::kNpos) {
+      scanned_ = true;
+    } else {
+      label_ = pos + delim_.Size();
+    }
+    // A run of empty fields collapses into a single one.
+    if (!field.Empty() || emitted_ == 0 || !field_.Empty()) {
+      field_ = field;
+      ++emitted_;
+      return;
+    }
+  }
+  // A lone empty field is reported twice, as String::Split does.
+  if (emitted_ == 1 && field_.Empty() && !str_.Empty()) {
+    ++emitted_;
+    return;
+  }
+  done_ = true;
+}
+
+std::vector<StringView> SplitFields(StringView str, StringView delim,
+                                    size_t threads) {
+  std::vector<StringView> result;
+  threads = std::min(threads, str.Size() / kParallelSplitChunk);
+  if (threads <= 1 || delim.Empty() || SelfOverlaps(delim)) {
+    for (StringView field : SplitRange(str, delim)) {
+      result.push_back(field);
+    }
+    return result;
+  }
+  // Chunk i spans [begins[i], ends[i]); the delimiter found at ends[i]
+  // separates it from chunk i + 1.
+  std::vector<size_t> begins{0};
+  std::vector<size_t> ends;
+  for (size_t i = 1; i < threads; ++i) {
+    size_t target = std::max(str.Size() / threads * i, begins.back());
+    size_t pos = SearchSubstring(str, target, delim);
+    if (pos == StringView::kNpos) {
+      break;
+    }
+    ends.push_back(pos);
+    begins.push_back(pos + delim.Size());
+  }
+  ends.push_back(str.Size());
+  std::vector<std::vector<StringView>> chunks(begins.size());
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < chunks.size(); ++i) {
+    workers.emplace_back(RawFields, str.Substr(begins[i], ends[i] - begins[i]),
+                         delim, std::ref(chunks[i]));
+  }
+  RawFields(str.Substr(0, ends[0]), delim, chunks[0]);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  // Same empty-field rules as SplitRange.
+  for (const std::vector<StringView>& chunk : chunks) {
+    for (StringView field : chunk) {
+      if (!field.Empty() || result.empty() || !result.back().Empty()) {
+        result.push_back(field);
+      }
+    }
+  }
+  if (result.size() == 1 && result[0].Empty()) {
+    result.push_back(result[0]);
+  }
+  return result;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "string_hash.hpp"
+
+// Non-owning (pointer, length) window into a character buffer. The viewed
+// characters must outlive the view.
+class StringView {
+ public:
+  static constexpr size_t kNpos = static_cast<size_t>(-1);
+  StringView() = default;
+  StringView(const char* str) : str_(str), size_(strlen(str)){};
+  StringView(const char* str, size_t size) : str_(str), size_(size){};
+  char operator[](size_t ind) const { return str_[ind]; };
+  char Front() const { return str_[0]; };
+  char Back() const { return str_[size_ - 1]; };
+  bool Empty() const { return size_ == 0; };
+  size_t Size() const { return size_; };
+  const char* Data() const { return str_; };
+  const char* begin() const { return str_; };
+  const char* end() const { return str_ + size_; };
+  StringView Substr(size_t pos, size_t count) const;
+  void RemovePrefix(size_t count);
+  void RemoveSuffix(size_t count);
+
+ private:
+  const char* str_ = nullptr;
+  size_t size_ = 0;
+};
+
+bool operator==(StringView lhs, StringView rhs);
+bool operator!=(StringView lhs, StringView rhs);
+bool operator<(StringView lhs, StringView rhs);
+bool operator>(StringView lhs, StringView rhs);
+bool operator<=(StringView lhs, StringView rhs);
+bool operator>=(StringView lhs, StringView rhs);
+std::ostream& operator<<(std::ostream& os, StringView str);
+
+// Lazy counterpart of String::Split: yields the same fields, in the same
+// order and with the same empty-field rules, as views into the source
+// buffer without allocating. Both the source and delim must outlive it.
+class SplitRange {
+ public:
+  class Iterator;
+
+  SplitRange(StringView str, StringView delim) : str_(str), delim_(delim){};
+  Iterator begin() const;
+  Iterator end() const;
+
+ private:
+  StringView str_;
+  StringView delim_;
+};
+
+class SplitRange::Iterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = StringView;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const StringView*;
+  using reference = const StringView&;
+
+  Iterator() = default;
+  Iterator(StringView str, StringView delim);
+  reference operator*() const { return field_; };
+  pointer operator->() const { return &field_; };
+  Iterator& operator++();
+  Iterator operator++(int);
+  bool operator==(const Iterator& other) const { return done_ == other.done_; };
+  bool operator!=(const Iterator& other) const { return !(*this == other); };
+
+ private:
+  void Advance();
+  StringView str_;
+  StringView delim_;
+  StringView field_;
+  size_t label_ = 0;
+  size_t emitted_ = 0;
+  bool scanned_ = false;
+  bool done_ = true;
+};
+
+// The fields String::Split would produce, as views. With threads > 1 and
+// an input of at least kParallelSplitChunk bytes per thread, the input is
+// cut at delimiter occurrences into roughly equal chunks that are scanned
+// concurrently. Delimiters that can overlap themselves ("aa", "abab") are
+// scanned sequentially, since a match found mid-buffer might not be one
+// that the left-to-right scan would take.
+const size_t kParallelSplitChunk = 1 << 16;
+std::vector<StringView> SplitFields(StringView str, StringView delim,
+                                    size_t threads = 1);
+
+namespace std {
+template <>
+struct hash<StringView> {
+  size_t operator()(StringView str) const {
+    return static_cast<size_t>(HashBytes(str.Data(), str.Size()));
+  }
+};
+}  // namespace std